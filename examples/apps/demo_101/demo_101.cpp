@@ -38,6 +38,7 @@
 #include <openthread/thread.h>
 
 #include <lwip/altcp_tcp.h>
+#include <lwip/api.h>
 #include <lwip/apps/http_client.h>
 #include <lwip/netdb.h>
 #include <lwip/tcpip.h>
@@ -46,6 +47,7 @@
 #include <nrfx/hal/nrf_gpiote.h>
 
 #include "net/utils/nat64_utils.h"
+#include "otr_state.h"
 
 #ifndef DEMO_PASSPHRASE
 #define DEMO_PASSPHRASE "ABCDEF"
@@ -94,6 +96,16 @@ static void WaitForSignal(uint32_t aSignal)
     } while ((notifyValue & aSignal) == 0);
 }
 
+static void WaitForAttach(void)
+{
+    otrStateSnapshot snapshot;
+
+    do
+    {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    } while (otrStateGet(otrGetInstance(), &snapshot) != OT_ERROR_NONE || snapshot.mRole < OT_DEVICE_ROLE_CHILD);
+}
+
 static void HttpDoneCallback(void *aArg, httpc_result_t aResult, uint32_t aLen, uint32_t aStatusCode, err_t aErr)
 {
     (void)aArg;
@@ -160,8 +172,8 @@ void demo101Task(void *p)
     printf("Enable thread\n");
     OT_API_CALL(otThreadSetEnabled(otrGetInstance(), true));
     setupNat64();
-    // wait a while for thread to connect
-    vTaskDelay(pdMS_TO_TICKS(2000));
+    // wait for thread to attach
+    WaitForAttach();
 
     // dns64 www.google.com
     printf("Start curl www.google.com\n");
@@ -182,6 +194,8 @@ void demo101Task(void *p)
         }
     }
 
+    // Name lookups block on the thread semaphore, which is not released with the task.
+    netconn_thread_cleanup();
     vTaskDelete(NULL);
 }
 
@@ -106,7 +106,4 @@ exit:
     {
         close(fd);
     }
-
-    gTestTask = NULL;
-    vTaskDelete(NULL);
 }
@@ -341,8 +341,4 @@ void mqttTask(void *p)
         printf("Publish message: %s\r\n", msg);
         vTaskDelay(pdMS_TO_TICKS(2000));
     }
-
-exit:
-    gTestTask = NULL;
-    vTaskDelete(NULL);
 }
@@ -29,12 +29,16 @@
 #include <FreeRTOS.h>
 #include <task.h>
 
+#include <lwip/api.h>
 #include <lwip/sockets.h>
 
 #include <openthread/ip6.h>
 #include <openthread/openthread-freertos.h>
 #include <openthread/thread.h>
 
+#include "otr_worker.h"
+#include "utils/time_utils.h"
+
 #define MAX_SEND_SIZE 1024
 
 struct ServerParams
@@ -62,8 +66,8 @@ static struct ServerParams  sServerParams  = {};
 static struct ConnectParams sConnectParams = {};
 static struct SendParams    sSendParams    = {};
 
-TaskHandle_t sServerTask = NULL;
-TaskHandle_t sClientTask = NULL;
+static TaskHandle_t sServerTask = NULL; ///< The echo server runs until its client leaves, so it has its own task.
+static otrWorkerJob sClientJob  = {};
 
 static void echoServerTask(void *p)
 {
@@ -158,6 +162,8 @@ exit:
     printf("tcp_echo_server: Finished\r\n");
 
     sServerTask = NULL;
+    // The socket calls block on the thread semaphore, which is not released with the task.
+    netconn_thread_cleanup();
     vTaskDelete(NULL);
 }
 
@@ -191,8 +197,6 @@ void connectTask(void *p)
     else
     {
         printf("tcp_client: Connected\r\n");
-        sClientTask = NULL;
-        vTaskDelete(NULL);
         return;
     }
 
@@ -203,9 +207,6 @@ exit:
         close(sClientSocket);
         sClientSocket = -1;
     }
-
-    sClientTask = NULL;
-    vTaskDelete(NULL);
 }
 
 void disconnectTask(void *p)
@@ -220,9 +221,6 @@ void disconnectTask(void *p)
     }
 
     printf("tcp_client: Disconnected\r\n");
-
-    sClientTask = NULL;
-    vTaskDelete(NULL);
 }
 
 void sendTask(void *p)
@@ -233,21 +231,21 @@ void sendTask(void *p)
     static const char req[] = {[0 ...(MAX_SEND_SIZE - 1)] = 'A'};
     char              res[MAX_SEND_SIZE + 1];
 
-    TickType_t start;
-    TickType_t stop;
-    uint32_t   msec;
-    uint32_t   sent  = 0;
-    uint32_t   recvd = 0;
-    uint32_t   throughput;
+    uint64_t start;
+    uint64_t stop;
+    uint64_t usec;
+    uint32_t sent  = 0;
+    uint32_t recvd = 0;
+    uint32_t throughput;
 
-    TickType_t lat_send_time;
-    TickType_t lat_recv_time;
-    uint64_t   lat_sum = 0;
-    uint32_t   lat_min = UINT32_MAX;
-    uint32_t   lat_max = 0;
-    uint32_t   lat;
+    uint64_t lat_send_time;
+    uint64_t lat_recv_time;
+    uint64_t lat_sum = 0;
+    uint32_t lat_min = UINT32_MAX;
+    uint32_t lat_max = 0;
+    uint32_t lat;
 
-    start = xTaskGetTickCount();
+    start = otrTimeGetUs();
 
     for (uint32_t i = 0; i < send_params->mCount; i++)
     {
@@ -256,7 +254,7 @@ void sendTask(void *p)
         sent  = 0;
         recvd = 0;
 
-        lat_send_time = xTaskGetTickCount();
+        lat_send_time = otrTimeGetUs();
 
         while (sent != send_params->mSize)
         {
@@ -295,9 +293,9 @@ void sendTask(void *p)
             recvd += rval;
         }
 
-        lat_recv_time = xTaskGetTickCount();
+        lat_recv_time = otrTimeGetUs();
 
-        lat = (lat_recv_time - lat_send_time) * portTICK_PERIOD_MS / 2;
+        lat = (uint32_t)((lat_recv_time - lat_send_time) / 2);
         lat_sum += lat;
 
         if (lat > lat_max)
@@ -314,22 +312,19 @@ void sendTask(void *p)
         printf("tcp_client: Received %dB: %s\r\n", rval, res);
     }
 
-    stop = xTaskGetTickCount();
-    msec = (stop - start) * portTICK_PERIOD_MS;
+    stop = otrTimeGetUs();
+    usec = (stop - start == 0) ? 1 : stop - start;
 
-    throughput = (100 * 8 * send_params->mSize * send_params->mCount) / msec;
+    throughput = (uint32_t)((uint64_t)100 * 8 * send_params->mSize * send_params->mCount * 1000 / usec);
 
     printf("tcp_client: Data transmitted : %" PRIu32 " B\r\n", send_params->mSize * send_params->mCount);
-    printf("tcp_client: Time             : %" PRIu32 " ms\r\n", msec);
+    printf("tcp_client: Time             : %" PRIu32 " ms\r\n", (uint32_t)(usec / 1000));
     printf("tcp_client: Throughput       : %" PRIu32 ".%" PRIu32 " Kb/s\r\n", throughput / 100, throughput % 100);
-    printf("tcp_client: Latency          : Avg: %" PRIu32 " ms Min: %" PRIu32 " ms, Max: %" PRIu32 " ms\r\n",
+    printf("tcp_client: Latency          : Avg: %" PRIu32 " us Min: %" PRIu32 " us, Max: %" PRIu32 " us\r\n",
            (uint32_t)lat_sum / send_params->mCount, lat_min, lat_max);
 
 exit:
     printf("tcp_client: Send finished\r\n");
-
-    sClientTask = NULL;
-    vTaskDelete(NULL);
 }
 
 bool startTcpEchoServer(otInstance *aInstance, uint16_t aPort)
@@ -338,9 +333,8 @@ bool startTcpEchoServer(otInstance *aInstance, uint16_t aPort)
     {
         sServerParams.mInstance = aInstance;
         sServerParams.mPort     = aPort;
-        UNUSED_VARIABLE(xTaskCreate(echoServerTask, "echo", MAX_SEND_SIZE + 1024, &sServerParams, 2, &sServerTask));
 
-        return true;
+        return xTaskCreate(echoServerTask, "echo", MAX_SEND_SIZE + 1024, &sServerParams, 2, &sServerTask) == pdPASS;
     }
 
     return false;
@@ -348,14 +342,15 @@ bool startTcpEchoServer(otInstance *aInstance, uint16_t aPort)
 
 bool startTcpConnect(otInstance *aInstance, char *aPeer, uint16_t aPort)
 {
-    if ((sClientTask == NULL) && (sClientSocket < 0))
+    if (!otrWorkerIsBusy(&sClientJob) && (sClientSocket < 0))
     {
         sConnectParams.mInstance = aInstance;
         sConnectParams.mPort     = aPort;
         strncpy(sConnectParams.mPeerAddr, aPeer, sizeof(sConnectParams.mPeerAddr));
-        UNUSED_VARIABLE(xTaskCreate(connectTask, "conn", 2048, &sConnectParams, 2, &sClientTask));
+        sClientJob.mHandler = connectTask;
+        sClientJob.mContext = &sConnectParams;
 
-        return true;
+        return otrWorkerSubmit(&sClientJob) == OT_ERROR_NONE;
     }
 
     return false;
@@ -363,11 +358,12 @@ bool startTcpConnect(otInstance *aInstance, char *aPeer, uint16_t aPort)
 
 bool startTcpDisconnect(void)
 {
-    if ((sClientTask == NULL) && (sClientSocket >= 0))
+    if (!otrWorkerIsBusy(&sClientJob) && (sClientSocket >= 0))
     {
-        UNUSED_VARIABLE(xTaskCreate(disconnectTask, "disc", 2048, NULL, 2, &sClientTask));
+        sClientJob.mHandler = disconnectTask;
+        sClientJob.mContext = NULL;
 
-        return true;
+        return otrWorkerSubmit(&sClientJob) == OT_ERROR_NONE;
     }
 
     return false;
@@ -375,14 +371,15 @@ bool startTcpDisconnect(void)
 
 bool startTcpSend(otInstance *aInstance, uint32_t count, uint32_t size)
 {
-    if ((sClientTask == NULL) && (sClientSocket >= 0))
+    if (!otrWorkerIsBusy(&sClientJob) && (sClientSocket >= 0))
     {
         sSendParams.mInstance = aInstance;
         sSendParams.mCount    = count;
         sSendParams.mSize     = size;
-        UNUSED_VARIABLE(xTaskCreate(sendTask, "send", MAX_SEND_SIZE + 1024, &sSendParams, 2, &sClientTask));
+        sClientJob.mHandler   = sendTask;
+        sClientJob.mContext   = &sSendParams;
 
-        return true;
+        return otrWorkerSubmit(&sClientJob) == OT_ERROR_NONE;
     }
 
     return false;
@@ -35,10 +35,20 @@
 #include <openthread/error.h>
 #include <openthread/openthread-freertos.h>
 
+#include <lwip/sys.h>
+
 #include "google_cloud_iot/client_cfg.h"
 #include "google_cloud_iot/mqtt_client.hpp"
+#include "netif.h"
+#include "otr_boot.h"
+#include "otr_profile.h"
+#include "otr_state.h"
+#include "otr_worker.h"
+#include "utils/lock_stats.h"
+#include "utils/time_utils.h"
 
-TaskHandle_t                            gTestTask = NULL;
+static otrWorkerJob                     sTestJob  = {};
+static TaskHandle_t                     sMqttTask = NULL; ///< The MQTT client never returns, so it has its own task.
 static ot::app::GoogleCloudIotClientCfg sCloudIotCfg;
 
 static otError parseLong(char *argv, long *aValue)
@@ -48,6 +58,16 @@ static otError parseLong(char *argv, long *aValue)
     return (*endptr == '\0') ? OT_ERROR_NONE : OT_ERROR_PARSE;
 }
 
+static void SubmitTestJob(void)
+{
+    otError error = otrWorkerSubmit(&sTestJob);
+
+    if (error != OT_ERROR_NONE)
+    {
+        otCliAppendResult(error);
+    }
+}
+
 static void ProcessTest(int argc, char *argv[])
 {
     if (argc < 1)
@@ -55,27 +75,39 @@ static void ProcessTest(int argc, char *argv[])
         return;
     }
 
-    if (gTestTask != NULL)
+    if (!strcmp(argv[0], "http"))
     {
-        otCliAppendResult(OT_ERROR_BUSY);
-    }
-    else if (!strcmp(argv[0], "http"))
-    {
-        xTaskCreate(httpTask, "http", 2048, otrGetInstance(), 2, &gTestTask);
+        if (otrWorkerIsBusy(&sTestJob))
+        {
+            otCliAppendResult(OT_ERROR_BUSY);
+        }
+        else
+        {
+            sTestJob.mHandler = httpTask;
+            sTestJob.mContext = otrGetInstance();
+            SubmitTestJob();
+        }
     }
     else if (!strcmp(argv[0], "mqtt"))
     {
-        sCloudIotCfg.mAddress         = CLOUDIOT_SERVER_ADDRESS;
-        sCloudIotCfg.mRootCertificate = CLOUDIOT_CERT;
-        sCloudIotCfg.mAlgorithm       = JWT_ALG_RS256;
-        sCloudIotCfg.mClientId        = CLOUDIOT_CLIENT_ID;
-        sCloudIotCfg.mDeviceId        = CLOUDIOT_DEVICE_ID;
-        sCloudIotCfg.mRegistryId      = CLOUDIOT_REGISTRY_ID;
-        sCloudIotCfg.mProjectId       = CLOUDIOT_PROJECT_ID;
-        sCloudIotCfg.mRegion          = CLOUDIOT_REGION;
-        sCloudIotCfg.mPrivKey         = CLOUDIOT_PRIV_KEY;
+        if (sMqttTask != NULL)
+        {
+            otCliAppendResult(OT_ERROR_BUSY);
+        }
+        else
+        {
+            sCloudIotCfg.mAddress         = CLOUDIOT_SERVER_ADDRESS;
+            sCloudIotCfg.mRootCertificate = CLOUDIOT_CERT;
+            sCloudIotCfg.mAlgorithm       = JWT_ALG_RS256;
+            sCloudIotCfg.mClientId        = CLOUDIOT_CLIENT_ID;
+            sCloudIotCfg.mDeviceId        = CLOUDIOT_DEVICE_ID;
+            sCloudIotCfg.mRegistryId      = CLOUDIOT_REGISTRY_ID;
+            sCloudIotCfg.mProjectId       = CLOUDIOT_PROJECT_ID;
+            sCloudIotCfg.mRegion          = CLOUDIOT_REGION;
+            sCloudIotCfg.mPrivKey         = CLOUDIOT_PRIV_KEY;
 
-        xTaskCreate(mqttTask, "mqtt", 3000, &sCloudIotCfg, 2, &gTestTask);
+            xTaskCreate(mqttTask, "mqtt", 3000, &sCloudIotCfg, 2, &sMqttTask);
+        }
     }
 }
 
@@ -169,13 +201,409 @@ static void ProcessSend(int argc, char *argv[])
     }
 }
 
+static void ProcessNetifTxBudget(int argc, char *argv[])
+{
+    long     packets;
+    long     bytes = 0;
+    uint16_t budgetPackets;
+    uint32_t budgetBytes;
+
+    if (argc == 0)
+    {
+        otrNetifGetTxBudget(&budgetPackets, &budgetBytes);
+        otCliOutputFormat("packets: %u, bytes: %lu\r\n", budgetPackets, static_cast<unsigned long>(budgetBytes));
+        return;
+    }
+
+    if (argc > 2)
+    {
+        otCliAppendResult(OT_ERROR_PARSE);
+        return;
+    }
+
+    if (parseLong(argv[0], &packets) != OT_ERROR_NONE || packets <= 0 || packets > UINT16_MAX)
+    {
+        otCliAppendResult(OT_ERROR_INVALID_ARGS);
+        return;
+    }
+
+    if (argc == 2 && (parseLong(argv[1], &bytes) != OT_ERROR_NONE || bytes < 0))
+    {
+        otCliAppendResult(OT_ERROR_INVALID_ARGS);
+        return;
+    }
+
+    otrNetifSetTxBudget(static_cast<uint16_t>(packets), static_cast<uint32_t>(bytes));
+}
+
+static void ProcessNetifStats(int argc, char *argv[])
+{
+    otrNetifStats stats;
+    unsigned long average = 0;
+
+    if (argc == 1 && strcmp(argv[0], "reset") == 0)
+    {
+        otrNetifResetStats();
+        return;
+    }
+
+    if (argc != 0)
+    {
+        otCliAppendResult(OT_ERROR_PARSE);
+        return;
+    }
+
+    otrNetifGetStats(&stats);
+
+    otCliOutputFormat("tx queued: %lu, queue drops: %lu, alloc failures: %lu\r\n",
+                      static_cast<unsigned long>(stats.mTxQueued), static_cast<unsigned long>(stats.mTxQueueDrops),
+                      static_cast<unsigned long>(stats.mTxAllocFailures));
+    otCliOutputFormat("tx packets: %lu, bytes: %lu, send failures: %lu\r\n",
+                      static_cast<unsigned long>(stats.mTxPackets), static_cast<unsigned long>(stats.mTxBytes),
+                      static_cast<unsigned long>(stats.mTxSendFailures));
+    otCliOutputFormat("rx packets: %lu, bytes: %lu, alloc failures: %lu, input failures: %lu\r\n",
+                      static_cast<unsigned long>(stats.mRxPackets), static_cast<unsigned long>(stats.mRxBytes),
+                      static_cast<unsigned long>(stats.mRxAllocFailures),
+                      static_cast<unsigned long>(stats.mRxInputFailures));
+    otCliOutputFormat("tx queue depth: %u, high water: %u\r\n", stats.mTxQueueDepth, stats.mTxQueueHighWater);
+    otCliOutputFormat("tcp mss clamped: %lu\r\n", static_cast<unsigned long>(stats.mTcpMssClamped));
+
+    if (stats.mTxLatency.mCount != 0)
+    {
+        average = static_cast<unsigned long>(stats.mTxLatency.mSum / stats.mTxLatency.mCount);
+    }
+
+    otCliOutputFormat("tx latency(us): count: %lu, max: %lu, avg: %lu\r\n",
+                      static_cast<unsigned long>(stats.mTxLatency.mCount),
+                      static_cast<unsigned long>(stats.mTxLatency.mMax), average);
+
+    for (uint8_t i = 0; i < OTR_HISTOGRAM_NUM_BUCKETS; i++)
+    {
+        if (stats.mTxLatency.mBuckets[i] != 0)
+        {
+            otCliOutputFormat("  <= %lu: %lu\r\n", static_cast<unsigned long>(otrHistogramBucketLimit(i)),
+                              static_cast<unsigned long>(stats.mTxLatency.mBuckets[i]));
+        }
+    }
+}
+
+static void ProcessNetifMss(int argc, char *argv[])
+{
+    long     frames;
+    long     hops = 1;
+    uint8_t  clampFrames;
+    uint8_t  clampHops;
+    uint16_t clampMss;
+
+    if (argc == 0)
+    {
+        otrNetifGetMssClamp(&clampFrames, &clampHops, &clampMss);
+
+        if (clampFrames == 0)
+        {
+            otCliOutputFormat("disabled\r\n");
+        }
+        else
+        {
+            otCliOutputFormat("frames: %u, hops: %u, mss: %u\r\n", clampFrames, clampHops, clampMss);
+        }
+        return;
+    }
+
+    if (argc == 1 && strcmp(argv[0], "off") == 0)
+    {
+        otrNetifSetMssClamp(0, 1);
+        return;
+    }
+
+    if (argc > 2)
+    {
+        otCliAppendResult(OT_ERROR_PARSE);
+        return;
+    }
+
+    if (parseLong(argv[0], &frames) != OT_ERROR_NONE || frames <= 0 || frames > UINT8_MAX)
+    {
+        otCliAppendResult(OT_ERROR_INVALID_ARGS);
+        return;
+    }
+
+    if (argc == 2 && (parseLong(argv[1], &hops) != OT_ERROR_NONE || hops <= 0 || hops > UINT8_MAX))
+    {
+        otCliAppendResult(OT_ERROR_INVALID_ARGS);
+        return;
+    }
+
+    otrNetifSetMssClamp(static_cast<uint8_t>(frames), static_cast<uint8_t>(hops));
+}
+
+static void ProcessOtState(int argc, char *argv[])
+{
+    static const char *const kRoleNames[] = {"disabled", "detached", "child", "router", "leader"};
+    otrStateSnapshot         snapshot;
+
+    (void)argv;
+
+    if (argc != 0)
+    {
+        otCliAppendResult(OT_ERROR_PARSE);
+        return;
+    }
+
+    if (otrStateGet(otrGetInstance(), &snapshot) != OT_ERROR_NONE)
+    {
+        otCliAppendResult(OT_ERROR_INVALID_STATE);
+        return;
+    }
+
+    otCliOutputFormat("version: %lu, role: %s, rloc16: 0x%04x\r\n", static_cast<unsigned long>(snapshot.mVersion),
+                      (snapshot.mRole < sizeof(kRoleNames) / sizeof(kRoleNames[0])) ? kRoleNames[snapshot.mRole] : "?",
+                      snapshot.mRloc16);
+    otCliOutputFormat("ip6: %s, link: %s, panid: 0x%04x, channel: %u, partition: %lu\r\n",
+                      snapshot.mIp6Enabled ? "up" : "down", snapshot.mLinkEnabled ? "up" : "down", snapshot.mPanId,
+                      snapshot.mChannel, static_cast<unsigned long>(snapshot.mPartitionId));
+
+    for (uint8_t i = 0; i < snapshot.mNumAddresses; i++)
+    {
+        const uint8_t *address = snapshot.mAddresses[i].mFields.m8;
+
+        otCliOutputFormat("%x:%x:%x:%x:%x:%x:%x:%x\r\n", (address[0] << 8) | address[1], (address[2] << 8) | address[3],
+                          (address[4] << 8) | address[5], (address[6] << 8) | address[7],
+                          (address[8] << 8) | address[9], (address[10] << 8) | address[11],
+                          (address[12] << 8) | address[13], (address[14] << 8) | address[15]);
+    }
+}
+
+static void ProcessMainloopStats(int argc, char *argv[])
+{
+    otrProfileStats stats;
+
+    if (argc == 1 && strcmp(argv[0], "reset") == 0)
+    {
+        otrProfileResetStats();
+        return;
+    }
+
+    if (argc != 0)
+    {
+        otCliAppendResult(OT_ERROR_PARSE);
+        return;
+    }
+
+    if (otrProfileGetStats(&stats) != OT_ERROR_NONE)
+    {
+        otCliAppendResult(OT_ERROR_NOT_IMPLEMENTED);
+        return;
+    }
+
+    for (uint8_t stage = 0; stage < OTR_PROFILE_NUM_STAGES; stage++)
+    {
+        const otrHistogram &histogram = stats.mStages[stage];
+        unsigned long       average   = 0;
+
+        if (histogram.mCount != 0)
+        {
+            average = static_cast<unsigned long>(histogram.mSum / histogram.mCount);
+        }
+
+        otCliOutputFormat("%s(us): count: %lu, max: %lu, avg: %lu\r\n",
+                          otrProfileStageName(static_cast<otrProfileStage>(stage)),
+                          static_cast<unsigned long>(histogram.mCount), static_cast<unsigned long>(histogram.mMax),
+                          average);
+
+        for (uint8_t i = 0; i < OTR_HISTOGRAM_NUM_BUCKETS; i++)
+        {
+            if (histogram.mBuckets[i] != 0)
+            {
+                otCliOutputFormat("  <= %lu: %lu\r\n", static_cast<unsigned long>(otrHistogramBucketLimit(i)),
+                                  static_cast<unsigned long>(histogram.mBuckets[i]));
+            }
+        }
+    }
+}
+
+static void OutputLockCounters(const char *aName, const otrLockStatsCounters &aCounters)
+{
+    unsigned long waitAverage = 0;
+    unsigned long holdAverage = 0;
+
+    if (aCounters.mAcquired != 0)
+    {
+        waitAverage = static_cast<unsigned long>(aCounters.mWaitTotal / aCounters.mAcquired);
+        holdAverage = static_cast<unsigned long>(aCounters.mHoldTotal / aCounters.mAcquired);
+    }
+
+    otCliOutputFormat("%s: acquired: %lu, contended: %lu, wait(us) avg: %lu, max: %lu, hold(us) avg: %lu, max: %lu\r\n",
+                      aName, static_cast<unsigned long>(aCounters.mAcquired),
+                      static_cast<unsigned long>(aCounters.mContended), waitAverage,
+                      static_cast<unsigned long>(aCounters.mWaitMax), holdAverage,
+                      static_cast<unsigned long>(aCounters.mHoldMax));
+}
+
+static void ProcessLockStats(int argc, char *argv[])
+{
+    static otrLockStats stats; // Too large for the CLI stack.
+
+    if (argc == 1 && strcmp(argv[0], "reset") == 0)
+    {
+        otrLockStatsReset();
+        return;
+    }
+
+    if (argc != 0)
+    {
+        otCliAppendResult(OT_ERROR_PARSE);
+        return;
+    }
+
+    if (!otrLockStatsGet(&stats))
+    {
+        otCliAppendResult(OT_ERROR_NOT_IMPLEMENTED);
+        return;
+    }
+
+    for (uint8_t lock = 0; lock < OTR_LOCK_STATS_NUM_LOCKS; lock++)
+    {
+        OutputLockCounters(otrLockStatsLockName(static_cast<otrLockStatsLock>(lock)), stats.mLocks[lock]);
+
+        for (uint8_t i = 0; i < stats.mNumTasks; i++)
+        {
+            if (stats.mTasks[i].mLocks[lock].mAcquired != 0)
+            {
+                otCliOutputFormat("  ");
+                OutputLockCounters(stats.mTasks[i].mName, stats.mTasks[i].mLocks[lock]);
+            }
+        }
+    }
+
+    otCliOutputFormat("untracked acquisitions: %lu\r\n", static_cast<unsigned long>(stats.mUntracked));
+}
+
+static void ProcessEventStats(int argc, char *argv[])
+{
+    otrEventStats stats;
+
+    if (argc == 1 && strcmp(argv[0], "reset") == 0)
+    {
+        otrEventResetStats();
+        return;
+    }
+
+    if (argc != 0)
+    {
+        otCliAppendResult(OT_ERROR_PARSE);
+        return;
+    }
+
+    otrEventGetStats(&stats);
+
+    for (uint8_t event = 0; event < OTR_NUM_EVENTS; event++)
+    {
+        otCliOutputFormat("%s: %lu\r\n", otrEventName(static_cast<otrEvent>(event)),
+                          static_cast<unsigned long>(stats.mSignals[event]));
+    }
+
+    otCliOutputFormat("wakeups: %lu\r\n", static_cast<unsigned long>(stats.mWakeups));
+}
+
+static void ProcessBootStats(int argc, char *argv[])
+{
+    uint32_t previous = 0;
+
+    (void)argv;
+
+    if (argc != 0)
+    {
+        otCliAppendResult(OT_ERROR_PARSE);
+        return;
+    }
+
+    for (uint8_t phase = 0; phase < OTR_BOOT_NUM_PHASES; phase++)
+    {
+        const char *name = otrBootPhaseName(static_cast<otrBootPhase>(phase));
+        uint32_t    time;
+
+        if (otrBootGetTime(static_cast<otrBootPhase>(phase), &time))
+        {
+            otCliOutputFormat("%s(us): %lu (+%lu)\r\n", name, static_cast<unsigned long>(time),
+                              static_cast<unsigned long>(time - previous));
+            previous = time;
+        }
+        else
+        {
+            otCliOutputFormat("%s(us): -\r\n", name);
+        }
+    }
+}
+
+static unsigned long NanosecondsPerIteration(uint64_t aStart, uint64_t aEnd, long aIterations)
+{
+    return static_cast<unsigned long>((aEnd - aStart) * 1000 / static_cast<uint64_t>(aIterations));
+}
+
+static void ProcessProtectBench(int argc, char *argv[])
+{
+    long        iterations = 10000;
+    sys_mutex_t mutex;
+    uint64_t    start;
+    uint64_t    end;
+
+    if (argc > 1 || (argc == 1 && (parseLong(argv[0], &iterations) != OT_ERROR_NONE || iterations <= 0)))
+    {
+        otCliAppendResult(OT_ERROR_INVALID_ARGS);
+        return;
+    }
+
+    // A mutex like the one `SYS_ARCH_PROTECT` used to take, as the baseline.
+    if (sys_mutex_new(&mutex) != ERR_OK)
+    {
+        otCliAppendResult(OT_ERROR_NO_BUFS);
+        return;
+    }
+
+    start = otrTimeGetUs();
+
+    for (long i = 0; i < iterations; i++)
+    {
+        sys_mutex_lock(&mutex);
+        sys_mutex_unlock(&mutex);
+    }
+
+    end = otrTimeGetUs();
+    sys_mutex_free(&mutex);
+    otCliOutputFormat("mutex(ns): %lu\r\n", NanosecondsPerIteration(start, end, iterations));
+
+    start = otrTimeGetUs();
+
+    for (long i = 0; i < iterations; i++)
+    {
+        SYS_ARCH_DECL_PROTECT(level);
+
+        SYS_ARCH_PROTECT(level);
+        SYS_ARCH_UNPROTECT(level);
+    }
+
+    end = otrTimeGetUs();
+    otCliOutputFormat("protect(ns): %lu\r\n", NanosecondsPerIteration(start, end, iterations));
+}
+
 static const struct otCliCommand sCommands[] = {{"test", ProcessTest},
                                                 {"tcp_echo_server", ProcessEchoServer},
                                                 {"tcp_connect", ProcessConnect},
                                                 {"tcp_disconnect", ProcessDisconnect},
-                                                {"tcp_send", ProcessSend}};
+                                                {"tcp_send", ProcessSend},
+                                                {"netif_tx_budget", ProcessNetifTxBudget},
+                                                {"netif_stats", ProcessNetifStats},
+                                                {"netif_mss", ProcessNetifMss},
+                                                {"ot_state", ProcessOtState},
+                                                {"mainloop_stats", ProcessMainloopStats},
+                                                {"lock_stats", ProcessLockStats},
+                                                {"boot_stats", ProcessBootStats},
+                                                {"event_stats", ProcessEventStats},
+                                                {"protect_bench", ProcessProtectBench}};
 
 void otrUserInit(void)
 {
+    otrWorkerInit();
     otCliSetUserCommands(sCommands, sizeof(sCommands) / sizeof(sCommands[0]));
 }
@@ -38,8 +38,6 @@
 extern "C" {
 #endif
 
-extern TaskHandle_t gTestTask;
-
 void httpTask(void *p);
 void mqttTask(void *p);
 
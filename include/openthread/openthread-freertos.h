@@ -35,8 +35,12 @@
 #ifndef OPENTHREAD_FREERTOS
 #define OPENTHREAD_FREERTOS
 
+#include <stdbool.h>
+
 #include <FreeRTOS.h>
 #include <portmacro.h>
+#include <task.h>
+#include <openthread/error.h>
 #include <openthread/instance.h>
 
 #include "portable/portable.h"
@@ -57,21 +61,165 @@ void otrInit(int argc, char *argv[]);
  */
 void otrStart(void);
 
+/**
+ * This enumeration defines the events that wake the OpenThread task.
+ *
+ * Each event is a bit of the OpenThread task notification value, and the task only runs the stages whose event is set.
+ *
+ */
+typedef enum otrEvent
+{
+    OTR_EVENT_COMMAND,  ///< A command or lock request was queued. Runs the command stage.
+    OTR_EVENT_TASKLET,  ///< OpenThread tasklets are pending. Runs the tasklet stage.
+    OTR_EVENT_DRIVER,   ///< A platform driver (radio, alarm, UART) has work. Runs the driver stage.
+    OTR_EVENT_NETIF,    ///< Packets or address changes are pending between OpenThread and lwIP. Runs the netif stage.
+    OTR_EVENT_API_CALL, ///< An `OT_API_CALL` returned. Runs the tasklet stage.
+    OTR_NUM_EVENTS,
+} otrEvent;
+
+/**
+ * This macro returns the notification bit of an event.
+ *
+ */
+#define OTR_EVENT_BIT(aEvent) (1UL << (aEvent))
+
+/**
+ * This structure represents the wakeup counters of the OpenThread task.
+ *
+ */
+typedef struct otrEventStats
+{
+    uint32_t mSignals[OTR_NUM_EVENTS]; ///< Signals per event, several signals may be served by one wakeup.
+    uint32_t mWakeups;                 ///< Times the OpenThread task returned from a blocking wait.
+} otrEventStats;
+
+/**
+ * This function signals an event to the OpenThread task.
+ *
+ * @param[in]  aEvent  The event.
+ *
+ */
+void otrEventSignal(otrEvent aEvent);
+
+/**
+ * This function signals an event to the OpenThread task from ISR.
+ *
+ * @param[in]  aEvent  The event.
+ *
+ */
+void otrEventSignalFromISR(otrEvent aEvent);
+
 /**
  * This function notifies OpenThread task.
  *
+ * Kept for existing callers, it signals `OTR_EVENT_DRIVER`. New code should signal the event it means with
+ * `otrEventSignal`.
+ *
  */
 void otrTaskNotifyGive(void);
 
 /**
  * This function notifies OpenThread task from ISR.
  *
+ * Kept for existing callers, it signals `OTR_EVENT_DRIVER`. New code should signal the event it means with
+ * `otrEventSignalFromISR`.
+ *
  */
 void otrTaskNotifyGiveFromISR(void);
 
+/**
+ * This function gets the wakeup counters of the OpenThread task.
+ *
+ * @param[out]  aStats  A pointer to where to copy the counters.
+ *
+ */
+void otrEventGetStats(otrEventStats *aStats);
+
+/**
+ * This function clears the wakeup counters of the OpenThread task.
+ *
+ */
+void otrEventResetStats(void);
+
+/**
+ * This function returns the name of an event.
+ *
+ * @param[in]  aEvent  The event.
+ *
+ * @returns The name of @p aEvent.
+ *
+ */
+const char *otrEventName(otrEvent aEvent);
+
+/**
+ * The task notification bit used to signal command completion to the waiting task.
+ *
+ */
+#define OTR_COMMAND_NOTIFY_VALUE (1UL << 31)
+
+/**
+ * This function pointer is called in the OpenThread task to run a command.
+ *
+ * @param[in]  aContext  The context of the command.
+ *
+ */
+typedef void (*otrCommandHandler)(void *aContext);
+
+/**
+ * This structure represents a command run by the OpenThread task.
+ *
+ * A command with @p mWaiter set must stay valid until it is waited for with `otrCommandWait`, and a task may have
+ * only one such command outstanding. A command without a waiter is not accessed by the OpenThread task once its handler
+ * is called, so the handler may free it.
+ *
+ */
+typedef struct otrCommand
+{
+    otrCommandHandler mHandler; ///< The function to run in the OpenThread task.
+    void *            mContext; ///< The argument passed to @p mHandler.
+    TaskHandle_t      mWaiter;  ///< The task notified with OTR_COMMAND_NOTIFY_VALUE on completion, or NULL.
+    volatile bool     mDone;    ///< Set by the OpenThread task once @p mHandler returned, if @p mWaiter is set.
+} otrCommand;
+
+/**
+ * This function queues a command to the OpenThread task without waiting for it.
+ *
+ * @param[in]  aCommand  A pointer to the command.
+ *
+ * @retval OT_ERROR_NONE     Successfully queued the command.
+ * @retval OT_ERROR_NO_BUFS  The command queue is full.
+ *
+ */
+otError otrCommandPost(otrCommand *aCommand);
+
+/**
+ * This function waits for a command posted by the current task to complete.
+ *
+ * It must be called once for every posted command with a waiter, even after @p mDone was seen set.
+ *
+ * @param[in]  aCommand  A pointer to the command, whose @p mWaiter must be the current task.
+ *
+ */
+void otrCommandWait(otrCommand *aCommand);
+
+/**
+ * This function runs a function in the OpenThread task and waits for it to return.
+ *
+ * It runs @p aHandler directly when called from the OpenThread task.
+ *
+ * @param[in]  aHandler  The function to run.
+ * @param[in]  aContext  The argument passed to @p aHandler.
+ *
+ */
+void otrCommandCall(otrCommandHandler aHandler, void *aContext);
+
 /**
  * This function locks OpenThread task.
  *
+ * The OpenThread task is parked between two mainloop passes until `otrUnlock` is called, so the caller can use the
+ * OpenThread API. Prefer `otrCommandCall` for new code, which does not hold the OpenThread task while the caller runs.
+ * The caller runs at least at the OpenThread task priority until it calls `otrUnlock`.
+ *
  */
 void otrLock(void);
 
@@ -123,13 +271,13 @@ portFORCE_INLINE static BaseType_t otrPortIsInsideInterrupt(void)
  *  @param[in]  ...    function call statement of OpenThread api
  *
  */
-#define OT_API_CALL(...)     \
-    do                       \
-    {                        \
-        otrLock();           \
-        __VA_ARGS__;         \
-        otrUnlock();         \
-        otrTaskNotifyGive(); \
+#define OT_API_CALL(...)                    \
+    do                                      \
+    {                                       \
+        otrLock();                          \
+        __VA_ARGS__;                        \
+        otrUnlock();                        \
+        otrEventSignal(OTR_EVENT_API_CALL); \
     } while (0)
 
 #ifdef __cplusplus
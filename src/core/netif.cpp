@@ -31,11 +31,16 @@
  *   This file implements lwip net interface with OpenThread.
  */
 
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <lwip/ip6.h>
 #include <lwip/mld6.h>
 #include <lwip/netif.h>
 #include <lwip/tcpip.h>
 #include <lwip/udp.h>
-#include <semphr.h>
+#include <lwip/prot/tcp.h>
+#include <lwip_hooks.h>
 
 #include <openthread/icmp6.h>
 #include <openthread/ip6.h>
@@ -53,24 +58,457 @@
 #include "lwip/sockets.h"
 
 #include "netif.h"
+#include "otr_boot.h"
+#include "otr_config.h"
+#include "utils/time_utils.h"
+
+/**
+ * This structure implements a fixed-capacity ring of lwIP packets queued for transmission to OpenThread.
+ *
+ * It has a single producer, `netifOutputIp6`, which lwIP always calls with the TCPIP core lock held, and a single
+ * consumer, the OpenThread task. Each index is written by one side only, so no lock is needed.
+ *
+ */
+struct OutputQueue
+{
+    struct
+    {
+        struct pbuf *mBuffer;
+        uint32_t     mEnqueueTime;
+    } mEntries[OTR_CONFIG_NETIF_OUTPUT_QUEUE_SIZE];
+    uint32_t mHead; ///< Next slot to dequeue, written by the consumer.
+    uint32_t mTail; ///< Next slot to enqueue, written by the producer.
+};
+
+/**
+ * This enumeration represents the egress priority classes, highest first.
+ *
+ */
+enum OutputPriority
+{
+    kOutputPriorityHigh   = 0, ///< Network control and latency-sensitive traffic.
+    kOutputPriorityNormal = 1, ///< Unmarked traffic.
+    kOutputPriorityLow    = 2, ///< Traffic marked as bulk or lower effort.
+    kNumOutputPriorities  = 3,
+};
+
+/**
+ * This enumeration represents the classes of unicast addresses, in the order they get an lwIP address slot.
+ *
+ */
+enum AddressClass
+{
+    kAddressClassLinkLocal  = 0, ///< The link-local address, always in slot 0.
+    kAddressClassPreferred  = 1, ///< Preferred addresses outside the mesh-local prefix (e.g. SLAAC or OMR).
+    kAddressClassMeshLocal  = 2, ///< The mesh-local EID.
+    kAddressClassDeprecated = 3, ///< Deprecated addresses outside the mesh-local prefix.
+    kAddressClassLocator    = 4, ///< RLOC and ALOCs.
+    kNumAddressClasses      = 5,
+};
+
+/**
+ * This structure holds the OpenThread addresses to be applied to the lwIP netif.
+ *
+ * It is written by the OpenThread task and read by the TCPIP thread, never both at once: the OpenThread task only
+ * takes a new snapshot after the TCPIP thread has cleared `mAddressSyncPending`.
+ *
+ */
+struct AddressSnapshot
+{
+    struct
+    {
+        otIp6Address mAddress;
+        uint8_t      mClass;
+    } mUnicast[OTR_CONFIG_NETIF_MAX_UNICAST_ADDRESSES];
+    otIp6Address mMulticast[OTR_CONFIG_NETIF_MAX_MULTICAST_ADDRESSES];
+    uint8_t      mNumUnicast;
+    uint8_t      mNumMulticast;
+};
 
-static const size_t kMaxIp6Size = 1500;
+static_assert((OTR_CONFIG_NETIF_OUTPUT_QUEUE_SIZE & (OTR_CONFIG_NETIF_OUTPUT_QUEUE_SIZE - 1)) == 0,
+              "OTR_CONFIG_NETIF_OUTPUT_QUEUE_SIZE must be a power of two");
+static_assert(OTR_CONFIG_NETIF_EGRESS_WEIGHT_HIGH > 0 && OTR_CONFIG_NETIF_EGRESS_WEIGHT_NORMAL > 0 &&
+                  OTR_CONFIG_NETIF_EGRESS_WEIGHT_LOW > 0,
+              "egress weights must be positive");
+
+static const uint8_t kDscpLowerEffort = 1;  // RFC 8622
+static const uint8_t kDscpCs1         = 8;  // RFC 4594
+static const uint8_t kDscpCs5         = 40; // CS5, VA, EF, CS6 and CS7 all sort above this
+static const uint8_t kDnsPort         = 53;
+
+// 802.15.4 and 6LoWPAN overheads used to derive the clamped TCP MSS.
+static const uint8_t kMacFrameOverhead = 21; // MAC header with short addresses, aux security header, MIC-32 and FCS
+static const uint8_t kMeshHeaderSize   = 5;  // Mesh header with short addresses, used when forwarded over several hops
+static const uint8_t kFrag1HeaderSize  = 4;
+static const uint8_t kFragNHeaderSize  = 5;
+static const uint8_t kIphcHeaderSize   = 20; // IPHC with both interface identifiers inline
+static const uint8_t kTcpHeaderSize    = 20;
+static const uint8_t kTcpOptionEnd     = 0;
+static const uint8_t kTcpOptionNop     = 1;
+static const uint8_t kTcpOptionMss     = 2;
+static const uint8_t kTcpOptionMssSize = 4;
+
+static const uint8_t kOutputWeights[kNumOutputPriorities] = {
+    OTR_CONFIG_NETIF_EGRESS_WEIGHT_HIGH, OTR_CONFIG_NETIF_EGRESS_WEIGHT_NORMAL, OTR_CONFIG_NETIF_EGRESS_WEIGHT_LOW};
 
 /**
- * This structure stores information needed to send a IPv6 packet.
+ * This structure holds the state of the lwIP netif bridged to the OpenThread instance.
  *
  */
-struct OutputEvent
+struct NetifContext
 {
-    OutputEvent *mNext;
-    uint16_t     mLength;
-    uint8_t      mData[1];
+    struct netif  mNetif;
+    otInstance *  mInstance;
+    OutputQueue   mOutputQueues[kNumOutputPriorities];
+    uint8_t       mOutputCredits[kNumOutputPriorities];
+    otrNetifStats mStats;
+    uint32_t      mTcpMssClampedRx; ///< Only written by the OpenThread task, lwIP counts into mStats.
+#if OTR_CONFIG_NETIF_DIRECT_INPUT
+    struct pbuf *mInputBatch[OTR_CONFIG_NETIF_RX_BATCH_SIZE];
+    uint8_t      mInputBatchLength;
+#endif
+    AddressSnapshot mAddressSnapshot;
+    otIp6Address    mJoinedGroups[OTR_CONFIG_NETIF_MAX_MULTICAST_ADDRESSES]; ///< Only used by the TCPIP thread.
+    uint8_t         mNumJoinedGroups;
+    bool            mAddressDirty;
+    bool            mAddressSyncPending;
 };
 
-static SemaphoreHandle_t sGuardOutput = NULL;
-static OutputEvent *     sHeadOutput  = NULL;
-static OutputEvent *     sLastOutput  = NULL;
-static struct netif      sNetif;
+static NetifContext sContext;
+static bool         sContextReady; ///< Set by the TCPIP thread once `sContext` is initialized.
+static uint16_t     sTxBudgetPackets = OTR_CONFIG_NETIF_TX_BUDGET_PACKETS;
+static uint32_t     sTxBudgetBytes   = OTR_CONFIG_NETIF_TX_BUDGET_BYTES;
+static uint8_t      sMssClampFrames  = OTR_CONFIG_NETIF_MSS_CLAMP_FRAMES;
+static uint8_t      sMssClampHops    = OTR_CONFIG_NETIF_MSS_CLAMP_HOPS;
+static uint16_t     sMssClamp;
+static bool         sDnsReady;
+
+static uint32_t outputTimestamp(void)
+{
+    // Only differences are used, which stay correct when the low 32 bits wrap.
+    return static_cast<uint32_t>(otrTimeGetUs());
+}
+
+static bool outputQueuePush(OutputQueue &aQueue, struct pbuf *aBuffer)
+{
+    bool     pushed = false;
+    uint32_t tail   = aQueue.mTail;
+    uint32_t head   = __atomic_load_n(&aQueue.mHead, __ATOMIC_ACQUIRE);
+
+    VerifyOrExit(tail - head < OTR_CONFIG_NETIF_OUTPUT_QUEUE_SIZE);
+
+    aQueue.mEntries[tail % OTR_CONFIG_NETIF_OUTPUT_QUEUE_SIZE].mBuffer      = aBuffer;
+    aQueue.mEntries[tail % OTR_CONFIG_NETIF_OUTPUT_QUEUE_SIZE].mEnqueueTime = outputTimestamp();
+    __atomic_store_n(&aQueue.mTail, tail + 1, __ATOMIC_RELEASE);
+    pushed = true;
+
+exit:
+    return pushed;
+}
+
+static struct pbuf *outputQueuePop(OutputQueue &aQueue, uint32_t &aEnqueueTime)
+{
+    struct pbuf *buffer = NULL;
+    uint32_t     head   = aQueue.mHead;
+    uint32_t     tail   = __atomic_load_n(&aQueue.mTail, __ATOMIC_ACQUIRE);
+
+    VerifyOrExit(head != tail);
+
+    buffer       = aQueue.mEntries[head % OTR_CONFIG_NETIF_OUTPUT_QUEUE_SIZE].mBuffer;
+    aEnqueueTime = aQueue.mEntries[head % OTR_CONFIG_NETIF_OUTPUT_QUEUE_SIZE].mEnqueueTime;
+    __atomic_store_n(&aQueue.mHead, head + 1, __ATOMIC_RELEASE);
+
+exit:
+    return buffer;
+}
+
+static bool outputQueueIsEmpty(const OutputQueue &aQueue)
+{
+    return __atomic_load_n(&aQueue.mHead, __ATOMIC_ACQUIRE) == __atomic_load_n(&aQueue.mTail, __ATOMIC_ACQUIRE);
+}
+
+static bool outputQueuesAreEmpty(const NetifContext &aContext)
+{
+    bool empty = true;
+
+    for (uint8_t i = 0; i < kNumOutputPriorities && empty; i++)
+    {
+        empty = outputQueueIsEmpty(aContext.mOutputQueues[i]);
+    }
+
+    return empty;
+}
+
+static uint16_t outputQueuesDepth(const NetifContext &aContext)
+{
+    uint32_t depth = 0;
+
+    for (uint8_t i = 0; i < kNumOutputPriorities; i++)
+    {
+        depth += __atomic_load_n(&aContext.mOutputQueues[i].mTail, __ATOMIC_ACQUIRE) -
+                 __atomic_load_n(&aContext.mOutputQueues[i].mHead, __ATOMIC_ACQUIRE);
+    }
+
+    return static_cast<uint16_t>(depth);
+}
+
+/**
+ * This function dequeues the next packet to send, by weighted round-robin (or strict priority) across classes.
+ *
+ */
+static struct pbuf *outputDequeue(NetifContext &aContext, uint32_t &aEnqueueTime)
+{
+    struct pbuf *buffer = NULL;
+
+    // A second round is only needed when every non-empty class has used up its credits.
+    for (uint8_t round = 0; round < 2 && buffer == NULL; round++)
+    {
+        for (uint8_t i = 0; i < kNumOutputPriorities && buffer == NULL; i++)
+        {
+            if (OTR_CONFIG_NETIF_EGRESS_STRICT_PRIORITY || aContext.mOutputCredits[i] > 0)
+            {
+                buffer = outputQueuePop(aContext.mOutputQueues[i], aEnqueueTime);
+            }
+
+            if (buffer != NULL && aContext.mOutputCredits[i] > 0)
+            {
+                aContext.mOutputCredits[i]--;
+            }
+        }
+
+        if (buffer == NULL)
+        {
+            memcpy(aContext.mOutputCredits, kOutputWeights, sizeof(aContext.mOutputCredits));
+        }
+    }
+
+    return buffer;
+}
+
+static OutputPriority classifyUnmarkedOutput(const struct pbuf *aBuffer, uint8_t aNextHeader)
+{
+    OutputPriority priority = kOutputPriorityNormal;
+
+    switch (aNextHeader)
+    {
+    case IP6_NEXTH_HOPBYHOP: // MLD reports
+    case IP6_NEXTH_ICMP6:
+        priority = kOutputPriorityHigh;
+        break;
+
+    case IP6_NEXTH_UDP:
+    {
+        uint16_t destPort = (pbuf_get_at(aBuffer, IP6_HLEN + 2) << 8) | pbuf_get_at(aBuffer, IP6_HLEN + 3);
+
+        if (destPort == kDnsPort)
+        {
+            priority = kOutputPriorityHigh;
+        }
+        break;
+    }
+
+    case IP6_NEXTH_TCP:
+    {
+        uint16_t headerLength = (pbuf_get_at(aBuffer, IP6_HLEN + 12) >> 4) * 4;
+        uint8_t  flags        = pbuf_get_at(aBuffer, IP6_HLEN + 13);
+
+        // Segments without payload (ACKs, SYNs, RSTs) skip ahead of bulk data. A FIN must stay behind the data it
+        // closes, so it keeps the normal class.
+        if (aBuffer->tot_len == IP6_HLEN + headerLength && (flags & TCP_FIN) == 0)
+        {
+            priority = kOutputPriorityHigh;
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    return priority;
+}
+
+/**
+ * This function maps an outgoing IPv6 packet to an egress priority class.
+ *
+ * Traffic marked with a DSCP (e.g. with the IP_TOS socket option) is classified by its code point. Unmarked traffic,
+ * which is everything lwIP sends by default, is classified from its headers.
+ *
+ */
+static OutputPriority classifyOutput(const struct pbuf *aBuffer)
+{
+    const struct ip6_hdr *header   = static_cast<const struct ip6_hdr *>(aBuffer->payload);
+    uint8_t               dscp     = IP6H_TC(header) >> 2;
+    OutputPriority        priority = kOutputPriorityNormal;
+
+    if (dscp == 0)
+    {
+        priority = classifyUnmarkedOutput(aBuffer, IP6H_NEXTH(header));
+    }
+    else if (dscp == kDscpLowerEffort || dscp == kDscpCs1)
+    {
+        priority = kOutputPriorityLow;
+    }
+    else if (dscp >= kDscpCs5)
+    {
+        priority = kOutputPriorityHigh;
+    }
+
+    return priority;
+}
+
+/**
+ * This function computes the largest TCP MSS whose segments fit in a number of 802.15.4 frames.
+ *
+ * @param[in]  aFrames  The number of frames per segment, 1 for unfragmented segments.
+ * @param[in]  aHops    The number of mesh hops, a mesh header is added to every frame above one hop.
+ *
+ */
+static uint16_t computeClampedMss(uint8_t aFrames, uint8_t aHops)
+{
+    uint16_t framePayload = OT_RADIO_FRAME_MAX_SIZE - kMacFrameOverhead - (aHops > 1 ? kMeshHeaderSize : 0);
+    uint16_t mss;
+
+    if (aFrames == 1)
+    {
+        mss = framePayload - kIphcHeaderSize - kTcpHeaderSize;
+    }
+    else
+    {
+        // Fragment offsets count the uncompressed datagram in units of 8 bytes.
+        uint32_t datagram = IP6_HLEN + ((framePayload - kFrag1HeaderSize - kIphcHeaderSize) & ~7U) +
+                            (aFrames - 1) * ((framePayload - kFragNHeaderSize) & ~7U);
+
+        if (datagram > OPENTHREAD_CONFIG_IP6_MAX_DATAGRAM_LENGTH)
+        {
+            datagram = OPENTHREAD_CONFIG_IP6_MAX_DATAGRAM_LENGTH;
+        }
+
+        mss = static_cast<uint16_t>(datagram - IP6_HLEN - kTcpHeaderSize);
+    }
+
+    return mss;
+}
+
+/**
+ * This function updates a one's complement checksum for a 16-bit field change (RFC 1624).
+ *
+ */
+static uint16_t checksumAdjust(uint16_t aChecksum, uint16_t aOld, uint16_t aNew)
+{
+    uint32_t sum = static_cast<uint16_t>(~aChecksum) + static_cast<uint16_t>(~aOld) + aNew;
+
+    sum = (sum & 0xffff) + (sum >> 16);
+    sum = (sum & 0xffff) + (sum >> 16);
+
+    return static_cast<uint16_t>(~sum);
+}
+
+static void applyMssClamp(uint8_t aFrames, uint8_t aHops)
+{
+    sMssClampFrames = aFrames;
+    sMssClampHops   = aHops;
+    sMssClamp       = (aFrames > 0) ? computeClampedMss(aFrames, aHops) : 0;
+}
+
+/**
+ * This function lowers the MSS option of a received or forwarded TCP SYN segment to the clamped MSS.
+ *
+ * Together with `otrNetifTcpOutOptions` for the segments lwIP builds, lwIP and the mesh peer both send segments that
+ * fit the frame budget. The netif MTU itself stays at the IPv6 minimum of 1280, which RFC 8200 does not allow a link
+ * to go below. Segments built by lwIP are already clamped when they get here, so this never patches one that lwIP
+ * keeps for retransmission.
+ *
+ * @returns TRUE if the segment was rewritten.
+ *
+ */
+static bool clampTcpMss(struct pbuf *aBuffer)
+{
+    bool     clamped = false;
+    uint16_t headerLength;
+    uint16_t offset;
+
+    VerifyOrExit(sMssClamp != 0 && aBuffer->tot_len >= IP6_HLEN + kTcpHeaderSize);
+    VerifyOrExit(IP6H_NEXTH(static_cast<const struct ip6_hdr *>(aBuffer->payload)) == IP6_NEXTH_TCP);
+    VerifyOrExit((pbuf_get_at(aBuffer, IP6_HLEN + 13) & TCP_SYN) != 0);
+
+    headerLength = (pbuf_get_at(aBuffer, IP6_HLEN + 12) >> 4) * 4;
+    VerifyOrExit(headerLength > kTcpHeaderSize && aBuffer->tot_len >= IP6_HLEN + headerLength);
+
+    offset = kTcpHeaderSize;
+
+    while (offset < headerLength)
+    {
+        uint8_t kind = pbuf_get_at(aBuffer, IP6_HLEN + offset);
+        uint8_t length;
+
+        VerifyOrExit(kind != kTcpOptionEnd);
+
+        if (kind == kTcpOptionNop)
+        {
+            offset++;
+            continue;
+        }
+
+        VerifyOrExit(offset + 1 < headerLength);
+        length = pbuf_get_at(aBuffer, IP6_HLEN + offset + 1);
+        VerifyOrExit(length >= 2 && offset + length <= headerLength);
+
+        if (kind == kTcpOptionMss && length == kTcpOptionMssSize)
+        {
+            uint16_t position = IP6_HLEN + offset + 2;
+            uint16_t mss      = (pbuf_get_at(aBuffer, position) << 8) | pbuf_get_at(aBuffer, position + 1);
+            uint16_t checksum = (pbuf_get_at(aBuffer, IP6_HLEN + 16) << 8) | pbuf_get_at(aBuffer, IP6_HLEN + 17);
+            uint16_t oldWord  = mss;
+            uint16_t newWord  = sMssClamp;
+
+            VerifyOrExit(mss > sMssClamp);
+
+            // A field at an odd offset adds to the checksum with its bytes swapped.
+            if (offset & 1)
+            {
+                oldWord = static_cast<uint16_t>((oldWord << 8) | (oldWord >> 8));
+                newWord = static_cast<uint16_t>((newWord << 8) | (newWord >> 8));
+            }
+
+            checksum = checksumAdjust(checksum, oldWord, newWord);
+
+            pbuf_put_at(aBuffer, position, static_cast<uint8_t>(sMssClamp >> 8));
+            pbuf_put_at(aBuffer, position + 1, static_cast<uint8_t>(sMssClamp & 0xff));
+            pbuf_put_at(aBuffer, IP6_HLEN + 16, static_cast<uint8_t>(checksum >> 8));
+            pbuf_put_at(aBuffer, IP6_HLEN + 17, static_cast<uint8_t>(checksum & 0xff));
+            ExitNow(clamped = true);
+        }
+
+        offset += length;
+    }
+
+exit:
+    return clamped;
+}
+
+uint32_t *otrNetifTcpOutOptions(struct tcp_hdr *aHeader, uint32_t *aOptions)
+{
+    uint8_t *option = reinterpret_cast<uint8_t *>(aHeader + 1);
+    uint16_t mss;
+
+    VerifyOrExit(sMssClamp != 0 && (TCPH_FLAGS(aHeader) & TCP_SYN) != 0);
+
+    // lwIP writes the MSS option first.
+    VerifyOrExit(reinterpret_cast<uint8_t *>(aOptions) >= option + kTcpOptionMssSize);
+    VerifyOrExit(option[0] == kTcpOptionMss && option[1] == kTcpOptionMssSize);
+
+    mss = static_cast<uint16_t>((option[2] << 8) | option[3]);
+    VerifyOrExit(mss > sMssClamp);
+
+    option[2] = static_cast<uint8_t>(sMssClamp >> 8);
+    option[3] = static_cast<uint8_t>(sMssClamp & 0xff);
+
+    sContext.mStats.mTcpMssClamped++;
+
+exit:
+    return aOptions;
+}
 
 static bool IsLinkLocal(const struct otIp6Address &aAddress)
 {
@@ -84,42 +522,71 @@ static void HandleNetifStatus(struct netif *aNetif)
     otLogInfoPlat("LwIP netif event");
 }
 
+/**
+ * This function takes a reference on a lwIP packet so it can be queued without copying.
+ *
+ * Packets referencing volatile memory (e.g. PBUF_REF) are cloned, as lwIP may reuse that memory once
+ * `output_ip6` returns.
+ *
+ */
+static struct pbuf *referenceBuffer(struct pbuf *aBuffer)
+{
+    struct pbuf *buffer = aBuffer;
+
+    for (struct pbuf *p = aBuffer; p != NULL; p = p->next)
+    {
+        if (PBUF_NEEDS_COPY(p))
+        {
+            ExitNow(buffer = pbuf_clone(PBUF_RAW, PBUF_RAM, aBuffer));
+        }
+    }
+
+    pbuf_ref(buffer);
+
+exit:
+    return buffer;
+}
+
 static err_t netifOutputIp6(struct netif *aNetif, struct pbuf *aBuffer, const ip6_addr_t *aPeerAddr)
 {
     (void)aPeerAddr;
 
-    err_t        err   = ERR_OK;
-    OutputEvent *event = NULL;
+    err_t         err     = ERR_MEM;
+    struct pbuf * buffer  = NULL;
+    NetifContext &context = *static_cast<NetifContext *>(aNetif->state);
+    OutputQueue & queue   = context.mOutputQueues[classifyOutput(aBuffer)];
+    uint16_t      depth;
 
     otLogInfoPlat("netif output");
-    assert(aNetif == &sNetif);
-    event = (OutputEvent *)malloc(sizeof(*event) + aBuffer->tot_len);
 
-    event->mLength = aBuffer->tot_len;
-    event->mNext   = NULL;
-    VerifyOrExit(event != NULL, err = ERR_BUF);
-    VerifyOrExit(aBuffer->tot_len == pbuf_copy_partial(aBuffer, event->mData, aBuffer->tot_len, 0), err = ERR_ARG);
+    buffer = referenceBuffer(aBuffer);
+    VerifyOrExit(buffer != NULL, context.mStats.mTxAllocFailures++);
 
-    xSemaphoreTake(sGuardOutput, portMAX_DELAY);
-    if (sLastOutput == NULL)
+    if (clampTcpMss(buffer))
     {
-        sHeadOutput = event;
-        sLastOutput = event;
+        context.mStats.mTcpMssClamped++;
     }
-    else
+
+    // Push back to lwIP when the ring is full, TCP keeps the segment and retries on ERR_MEM.
+    VerifyOrExit(outputQueuePush(queue, buffer), context.mStats.mTxQueueDrops++);
+
+    err = ERR_OK;
+    context.mStats.mTxQueued++;
+
+    depth = outputQueuesDepth(context);
+    if (depth > context.mStats.mTxQueueHighWater)
     {
-        sLastOutput->mNext = event;
+        context.mStats.mTxQueueHighWater = depth;
     }
-    xSemaphoreGive(sGuardOutput);
 
-    otrTaskNotifyGive();
+    otrEventSignal(OTR_EVENT_NETIF);
 
 exit:
     if (err != ERR_OK)
     {
-        if (event != NULL)
+        if (buffer != NULL)
         {
-            free(event);
+            pbuf_free(buffer);
         }
     }
     return err;
@@ -146,76 +613,256 @@ static err_t netifInit(struct netif *aNetif)
 
 struct netif *otrGetNetif(void)
 {
-    return &sNetif;
+    return &sContext.mNetif;
 }
 
-static void addMulticastAddress(const otIp6Address &aAddress)
+static AddressClass classifyAddress(const otNetifAddress &aAddress, const otMeshLocalPrefix &aMeshLocalPrefix)
 {
-    ip6_addr_t multicast_addr;
+    AddressClass addressClass;
 
-    memcpy(&multicast_addr.addr, &aAddress, sizeof(aAddress));
-    multicast_addr.zone = IP6_NO_ZONE;
-    mld6_joingroup_netif(&sNetif, &multicast_addr);
+    if (IsLinkLocal(aAddress.mAddress))
+    {
+        addressClass = kAddressClassLinkLocal;
+    }
+    else if (aAddress.mRloc)
+    {
+        addressClass = kAddressClassLocator;
+    }
+    else if (memcmp(&aAddress.mAddress, &aMeshLocalPrefix, sizeof(aMeshLocalPrefix.m8)) == 0)
+    {
+        addressClass = kAddressClassMeshLocal;
+    }
+    else if (aAddress.mPreferred)
+    {
+        addressClass = kAddressClassPreferred;
+    }
+    else
+    {
+        addressClass = kAddressClassDeprecated;
+    }
+
+    return addressClass;
 }
 
-static void addAddress(const otIp6Address &aAddress)
+static void takeAddressSnapshot(NetifContext &aContext)
 {
-    otError error = OT_ERROR_NONE;
-    err_t   err   = ERR_OK;
+    AddressSnapshot &        snapshot = aContext.mAddressSnapshot;
+    const otMeshLocalPrefix *prefix   = otThreadGetMeshLocalPrefix(aContext.mInstance);
 
-    LOCK_TCPIP_CORE();
+    snapshot.mNumUnicast   = 0;
+    snapshot.mNumMulticast = 0;
 
-    if (IsLinkLocal(aAddress))
+    for (const otNetifAddress *address = otIp6GetUnicastAddresses(aContext.mInstance); address != NULL;
+         address                       = address->mNext)
     {
-        netif_ip6_addr_set(&sNetif, 0, reinterpret_cast<const ip6_addr_t *>(&aAddress));
-        netif_ip6_addr_set_state(&sNetif, 0, IP6_ADDR_PREFERRED);
+        if (snapshot.mNumUnicast == OTR_CONFIG_NETIF_MAX_UNICAST_ADDRESSES)
+        {
+            otLogWarnPlat("Too many unicast addresses, ignoring the rest");
+            break;
+        }
+
+        snapshot.mUnicast[snapshot.mNumUnicast].mAddress = address->mAddress;
+        snapshot.mUnicast[snapshot.mNumUnicast].mClass   = classifyAddress(*address, *prefix);
+        snapshot.mNumUnicast++;
     }
-    else
+
+    for (const otNetifMulticastAddress *address = otIp6GetMulticastAddresses(aContext.mInstance); address != NULL;
+         address                                = address->mNext)
+    {
+        if (snapshot.mNumMulticast == OTR_CONFIG_NETIF_MAX_MULTICAST_ADDRESSES)
+        {
+            otLogWarnPlat("Too many multicast addresses, ignoring the rest");
+            break;
+        }
+
+        snapshot.mMulticast[snapshot.mNumMulticast++] = address->mAddress;
+    }
+}
+
+static u8_t addressState(uint8_t aClass)
+{
+    // Keep addresses in the mesh-local prefix out of lwIP source address selection for off-mesh peers.
+    return (aClass == kAddressClassPreferred || aClass == kAddressClassLinkLocal) ? IP6_ADDR_PREFERRED : IP6_ADDR_VALID;
+}
+
+static int8_t findUnicastAddress(const AddressSnapshot &aSnapshot, const ip6_addr_t *aAddress)
+{
+    int8_t index = -1;
+
+    for (uint8_t i = 0; i < aSnapshot.mNumUnicast; i++)
     {
-        int8_t                   index  = -1;
-        const otMeshLocalPrefix *prefix = otThreadGetMeshLocalPrefix(otrGetInstance());
+        if (memcmp(&aSnapshot.mUnicast[i].mAddress, aAddress->addr, sizeof(otIp6Address)) == 0)
+        {
+            ExitNow(index = static_cast<int8_t>(i));
+        }
+    }
+
+exit:
+    return index;
+}
 
-        err = netif_add_ip6_address(&sNetif, reinterpret_cast<const ip6_addr_t *>(&aAddress), &index);
-        VerifyOrExit(err == ERR_OK && index != -1, error = OT_ERROR_FAILED);
-        if (memcmp(&aAddress, prefix, sizeof(prefix->m8)) != 0)
+static bool containsAddress(const otIp6Address *aAddresses, uint8_t aCount, const otIp6Address &aAddress)
+{
+    bool found = false;
+
+    for (uint8_t i = 0; i < aCount && !found; i++)
+    {
+        found = (memcmp(&aAddresses[i], &aAddress, sizeof(aAddress)) == 0);
+    }
+
+    return found;
+}
+
+static void applyUnicastAddresses(NetifContext &aContext)
+{
+    const AddressSnapshot &snapshot                                         = aContext.mAddressSnapshot;
+    struct netif *         netif                                            = &aContext.mNetif;
+    bool                   placed[OTR_CONFIG_NETIF_MAX_UNICAST_ADDRESSES]   = {};
+    uint8_t                overflow                                         = 0;
+
+    // Drop what OpenThread no longer has and keep what both have, so addresses sockets may be bound to never move.
+    for (int8_t i = 0; i < LWIP_IPV6_NUM_ADDRESSES; i++)
+    {
+        int8_t index;
+
+        if (ip6_addr_isinvalid(netif_ip6_addr_state(netif, i)))
         {
-            netif_ip6_addr_set_state(&sNetif, index, IP6_ADDR_PREFERRED);
+            continue;
+        }
+
+        index = findUnicastAddress(snapshot, netif_ip6_addr(netif, i));
+
+        if (index == -1 || (i == 0) != (snapshot.mUnicast[index].mClass == kAddressClassLinkLocal))
+        {
+            netif_ip6_addr_set_state(netif, i, IP6_ADDR_INVALID);
         }
         else
         {
-            netif_ip6_addr_set_state(&sNetif, index, IP6_ADDR_VALID);
+            placed[index] = true;
+            netif_ip6_addr_set_state(netif, i, addressState(snapshot.mUnicast[index].mClass));
         }
     }
 
-exit:
-    UNLOCK_TCPIP_CORE();
+    // Fill the free slots class by class, in OpenThread order within a class.
+    for (uint8_t addressClass = kAddressClassLinkLocal; addressClass < kNumAddressClasses; addressClass++)
+    {
+        for (uint8_t i = 0; i < snapshot.mNumUnicast; i++)
+        {
+            const ip6_addr_t *address = reinterpret_cast<const ip6_addr_t *>(&snapshot.mUnicast[i].mAddress);
+            int8_t            index   = 0;
+
+            if (placed[i] || snapshot.mUnicast[i].mClass != addressClass)
+            {
+                continue;
+            }
+
+            if (addressClass == kAddressClassLinkLocal)
+            {
+                netif_ip6_addr_set(netif, 0, address);
+            }
+            else if (netif_add_ip6_address(netif, address, &index) != ERR_OK)
+            {
+                overflow++;
+                continue;
+            }
+
+            netif_ip6_addr_set_state(netif, index, addressState(addressClass));
+        }
+    }
 
-    if (error != OT_ERROR_NONE)
+    if (overflow > 0)
     {
-        otLogInfoPlat("Failed to add address: %d", error);
+        otLogWarnPlat("%u unicast addresses did not fit in the lwIP netif", overflow);
     }
 }
 
-static void delMulticastAddress(const otIp6Address &aAddress)
+static void applyMulticastAddresses(NetifContext &aContext)
 {
-    ip6_addr_t multicast_addr;
+    const AddressSnapshot &snapshot = aContext.mAddressSnapshot;
+    ip6_addr_t             group;
+
+    group.zone = IP6_NO_ZONE;
+
+    for (uint8_t i = aContext.mNumJoinedGroups; i > 0; i--)
+    {
+        otIp6Address &joined = aContext.mJoinedGroups[i - 1];
 
-    memcpy(&multicast_addr.addr, &aAddress, sizeof(aAddress));
-    multicast_addr.zone = IP6_NO_ZONE;
-    mld6_leavegroup_netif(&sNetif, &multicast_addr);
+        if (!containsAddress(snapshot.mMulticast, snapshot.mNumMulticast, joined))
+        {
+            memcpy(&group.addr, &joined, sizeof(joined));
+            mld6_leavegroup_netif(&aContext.mNetif, &group);
+            joined = aContext.mJoinedGroups[--aContext.mNumJoinedGroups];
+        }
+    }
+
+    for (uint8_t i = 0; i < snapshot.mNumMulticast; i++)
+    {
+        const otIp6Address &address = snapshot.mMulticast[i];
+
+        if (containsAddress(aContext.mJoinedGroups, aContext.mNumJoinedGroups, address))
+        {
+            continue;
+        }
+
+        memcpy(&group.addr, &address, sizeof(address));
+
+        if (mld6_joingroup_netif(&aContext.mNetif, &group) == ERR_OK)
+        {
+            aContext.mJoinedGroups[aContext.mNumJoinedGroups++] = address;
+        }
+        else
+        {
+            otLogWarnPlat("Failed to join multicast group");
+        }
+    }
 }
 
-static void delAddress(const otIp6Address &aAddress)
+/**
+ * This function applies the latest address snapshot to the lwIP netif.
+ *
+ * It runs in the TCPIP thread, so the whole diff is applied under a single acquisition of the core lock.
+ *
+ */
+static void applyAddresses(void *aContext)
 {
-    int8_t index;
+    NetifContext &context = *static_cast<NetifContext *>(aContext);
 
-    LOCK_TCPIP_CORE();
-    index = netif_get_ip6_addr_match(&sNetif, reinterpret_cast<const ip6_addr_t *>(&aAddress));
-    VerifyOrExit(index != -1);
-    netif_ip6_addr_set_state(&sNetif, index, IP6_ADDR_INVALID);
+    applyUnicastAddresses(context);
+    applyMulticastAddresses(context);
+
+    __atomic_store_n(&context.mAddressSyncPending, false, __ATOMIC_RELEASE);
+
+    // Pick up changes made while this snapshot was in flight.
+    otrEventSignal(OTR_EVENT_NETIF);
+}
+
+/**
+ * This function posts the OpenThread address set to the TCPIP thread when it changed since the last sync.
+ *
+ * A burst of address callbacks (e.g. on attach or partition change) only marks the set dirty, so it results in one
+ * snapshot and one deferred update.
+ *
+ */
+static void syncAddresses(NetifContext &aContext)
+{
+    VerifyOrExit(aContext.mAddressDirty && !__atomic_load_n(&aContext.mAddressSyncPending, __ATOMIC_ACQUIRE));
+
+    takeAddressSnapshot(aContext);
+    __atomic_store_n(&aContext.mAddressSyncPending, true, __ATOMIC_RELEASE);
+
+    if (tcpip_try_callback(applyAddresses, &aContext) == ERR_OK)
+    {
+        aContext.mAddressDirty = false;
+    }
+    else
+    {
+        // The TCPIP mailbox is full; retry on the next pass instead of blocking the OpenThread task.
+        __atomic_store_n(&aContext.mAddressSyncPending, false, __ATOMIC_RELEASE);
+        otrEventSignal(OTR_EVENT_NETIF);
+    }
 
 exit:
-    UNLOCK_TCPIP_CORE();
+    return;
 }
 
 static void setupDns(void)
@@ -233,26 +880,35 @@ static void setupDns(void)
     dnsServer.zone = IP6_NO_ZONE;
 #endif
 
-    dns_init();
+    // lwip_init() already ran dns_init().
     dns_setserver(0, &dnsServer);
 }
 
 static void processStateChange(otChangedFlags aFlags, void *aContext)
 {
-    otInstance *instance = static_cast<otInstance *>(aContext);
+    NetifContext &context = *static_cast<NetifContext *>(aContext);
 
-    if (OT_CHANGED_THREAD_NETIF_STATE | aFlags)
+    if (OT_CHANGED_THREAD_NETIF_STATE & aFlags)
     {
         LOCK_TCPIP_CORE();
-        if (otLinkIsEnabled(instance))
+        if (otLinkIsEnabled(context.mInstance))
         {
             otLogInfoPlat("netif up");
-            netif_set_up(&sNetif);
+            netif_set_up(&context.mNetif);
+
+            // Deferred from boot, DNS is of no use before the default interface is up.
+            if (!sDnsReady)
+            {
+                setupDns();
+                sDnsReady = true;
+            }
+
+            otrBootMark(OTR_BOOT_PHASE_NETIF_UP);
         }
         else
         {
             otLogInfoPlat("netif down");
-            netif_set_down(&sNetif);
+            netif_set_down(&context.mNetif);
         }
         UNLOCK_TCPIP_CORE();
     }
@@ -260,63 +916,87 @@ static void processStateChange(otChangedFlags aFlags, void *aContext)
 
 static void processAddress(const otIp6Address *aAddress, uint8_t aPrefixLength, bool aIsAdded, void *aContext)
 {
-    (void)aContext;
-
-    // All multicast addresses have prefix ff00::/8
-    bool isMulticast = (aAddress->mFields.m8[0] == 0xff);
+    (void)aAddress;
+    (void)aPrefixLength;
+    (void)aIsAdded;
 
     otLogInfoPlat("address changed");
 
-    if (aIsAdded)
+    // Applied by `netifProcess` once the current tasklets have run.
+    static_cast<NetifContext *>(aContext)->mAddressDirty = true;
+    otrEventSignal(OTR_EVENT_NETIF);
+}
+
+#if OTR_CONFIG_NETIF_DIRECT_INPUT
+/**
+ * This function passes the batched received packets to lwIP under a single acquisition of the TCPIP core lock.
+ *
+ */
+static void inputFlush(NetifContext &aContext)
+{
+    VerifyOrExit(aContext.mInputBatchLength > 0);
+
+    LOCK_TCPIP_CORE();
+
+    for (uint8_t i = 0; i < aContext.mInputBatchLength; i++)
     {
-        if (isMulticast)
-        {
-            addMulticastAddress(*aAddress);
-        }
-        else
-        {
-            addAddress(*aAddress);
-        }
-    }
-    else
-    {
-        if (isMulticast)
-        {
-            delMulticastAddress(*aAddress);
-        }
-        else
-        {
-            delAddress(*aAddress);
-        }
+        // ip6_input() always takes ownership of the packet.
+        ip6_input(aContext.mInputBatch[i], &aContext.mNetif);
     }
+
+    UNLOCK_TCPIP_CORE();
+
+    aContext.mInputBatchLength = 0;
+
+exit:
+    return;
 }
+#endif
 
 static void processReceive(otMessage *aMessage, void *aContext)
 {
-    otError      error      = OT_ERROR_NONE;
-    err_t        err        = ERR_OK;
-    const size_t kBlockSize = 128;
-    uint16_t     length     = otMessageGetLength(aMessage);
-    struct pbuf *buffer     = NULL;
-    otInstance * aInstance  = static_cast<otInstance *>(aContext);
-
-    assert(sNetif.state == aInstance);
+    otError       error   = OT_ERROR_NONE;
+    err_t         err     = ERR_OK;
+    uint16_t      length  = otMessageGetLength(aMessage);
+    uint16_t      offset  = 0;
+    struct pbuf * buffer  = NULL;
+    NetifContext &context = *static_cast<NetifContext *>(aContext);
 
     buffer = pbuf_alloc(PBUF_LINK, length, PBUF_POOL);
 
     VerifyOrExit(buffer != NULL, error = OT_ERROR_NO_BUFS);
 
-    for (uint16_t i = 0; i < length; i += kBlockSize)
+    // Read straight into each segment of the pbuf chain.
+    for (struct pbuf *p = buffer; p != NULL; p = p->next)
+    {
+        VerifyOrExit(otMessageRead(aMessage, offset, p->payload, p->len) == p->len, error = OT_ERROR_PARSE);
+        offset += p->len;
+    }
+
+    if (clampTcpMss(buffer))
     {
-        uint8_t block[kBlockSize];
-        int     count = otMessageRead(aMessage, i, block, sizeof(block));
+        context.mTcpMssClampedRx++;
+    }
+
+#if OTR_CONFIG_NETIF_DIRECT_INPUT
+    context.mInputBatch[context.mInputBatchLength++] = buffer;
 
-        assert(count > 0);
-        err = pbuf_take_at(buffer, block, count, i);
-        VerifyOrExit(err == ERR_OK, error = OT_ERROR_FAILED);
+    if (context.mInputBatchLength == OTR_CONFIG_NETIF_RX_BATCH_SIZE)
+    {
+        inputFlush(context);
+    }
+    else
+    {
+        // The rest of the batch is flushed by `netifProcess`.
+        otrEventSignal(OTR_EVENT_NETIF);
     }
+#else
+    err = context.mNetif.input(buffer, &context.mNetif);
+    VerifyOrExit(err == ERR_OK, error = OT_ERROR_FAILED);
+#endif
 
-    VerifyOrExit(ERR_OK == sNetif.input(buffer, &sNetif), error = OT_ERROR_FAILED);
+    context.mStats.mRxPackets++;
+    context.mStats.mRxBytes += length;
 
 exit:
     if (error != OT_ERROR_NONE)
@@ -326,8 +1006,13 @@ exit:
             pbuf_free(buffer);
         }
 
-        if (error == OT_ERROR_FAILED)
+        if (error == OT_ERROR_NO_BUFS)
+        {
+            context.mStats.mRxAllocFailures++;
+        }
+        else if (error == OT_ERROR_FAILED)
         {
+            context.mStats.mRxInputFailures++;
             otLogWarnPlat("%s failed for lwip error %d", __func__, err);
         }
 
@@ -337,38 +1022,36 @@ exit:
     otMessageFree(aMessage);
 }
 
-static void processTransmit(otInstance *aInstance)
+static void processTransmit(NetifContext &aContext, struct pbuf *aBuffer, uint32_t aEnqueueTime)
 {
     otError    error   = OT_ERROR_NONE;
     otMessage *message = NULL;
+    uint16_t   length  = aBuffer->tot_len;
 
-    VerifyOrExit(sHeadOutput != NULL);
-
-    message = otIp6NewMessage(aInstance, NULL);
+    message = otIp6NewMessage(aContext.mInstance, NULL);
     VerifyOrExit(message != NULL, error = OT_ERROR_NO_BUFS);
 
-    SuccessOrExit(error = otMessageAppend(message, sHeadOutput->mData, sHeadOutput->mLength));
+    for (struct pbuf *p = aBuffer; p != NULL; p = p->next)
+    {
+        SuccessOrExit(error = otMessageAppend(message, p->payload, p->len));
+    }
 
-    error   = otIp6Send(aInstance, message);
+    error   = otIp6Send(aContext.mInstance, message);
     message = NULL;
 
-    {
-        OutputEvent *nextEvent = sHeadOutput->mNext;
+    otrHistogramAdd(&aContext.mStats.mTxLatency, outputTimestamp() - aEnqueueTime);
+    SuccessOrExit(error);
 
-        free(sHeadOutput);
-        sHeadOutput = nextEvent;
-    }
-
-    // Notify if more
-    if (sHeadOutput == NULL)
-    {
-        sLastOutput = NULL;
-    }
-    otrTaskNotifyGive();
+    aContext.mStats.mTxPackets++;
+    aContext.mStats.mTxBytes += length;
 
 exit:
+    pbuf_free(aBuffer);
+
     if (error != OT_ERROR_NONE)
     {
+        aContext.mStats.mTxSendFailures++;
+
         if (message != NULL)
         {
             otMessageFree(message);
@@ -380,40 +1063,126 @@ exit:
 
 void netifInit(void *aContext)
 {
-    otInstance *instance = static_cast<otInstance *>(aContext);
+    otInstance *  instance = static_cast<otInstance *>(aContext);
+    NetifContext &context  = sContext;
+
+#if OTR_CONFIG_NETIF_DIRECT_INPUT
+    // Only IPv6 comes from OpenThread, and anything lwIP itself feeds back (e.g. loopback) holds the core lock.
+    netif_input_fn input = ip6_input;
+#else
+    netif_input_fn input = tcpip_input;
+#endif
+
+    memset(&context, 0, sizeof(context));
+    context.mInstance     = instance;
+    context.mAddressDirty = true;
+    memcpy(context.mOutputCredits, kOutputWeights, sizeof(context.mOutputCredits));
 
-    memset(&sNetif, 0, sizeof(sNetif));
     // LOCK_TCPIP_CORE();
 #if LWIP_IPV4
-    netif_add(&sNetif, NULL, NULL, NULL, instance, netifInit, tcpip_input);
+    netif_add(&context.mNetif, NULL, NULL, NULL, &context, netifInit, input);
 #else
-    netif_add(&sNetif, instance, netifInit, tcpip_input);
+    netif_add(&context.mNetif, &context, netifInit, input);
 #endif
-    netif_set_link_up(&sNetif);
-    netif_set_status_callback(&sNetif, HandleNetifStatus);
+    netif_set_link_up(&context.mNetif);
+    netif_set_status_callback(&context.mNetif, HandleNetifStatus);
     // UNLOCK_TCPIP_CORE();
 
-    sGuardOutput = xSemaphoreCreateMutex();
-    xSemaphoreGive(sGuardOutput);
-    assert(sGuardOutput != NULL);
     otLogInfoPlat("Initialize netif");
 
-    otIp6SetAddressCallback(instance, processAddress, instance);
-    otIp6SetReceiveCallback(instance, processReceive, instance);
-    otSetStateChangedCallback(instance, processStateChange, instance);
+    otIp6SetAddressCallback(instance, processAddress, &context);
+    otIp6SetReceiveCallback(instance, processReceive, &context);
+    otSetStateChangedCallback(instance, processStateChange, &context);
     otIp6SetReceiveFilterEnabled(instance, true);
     otIcmp6SetEchoMode(instance, OT_ICMP6_ECHO_HANDLER_DISABLED);
 
-    netif_set_default(&sNetif);
+    netif_set_default(&context.mNetif);
+    applyMssClamp(sMssClampFrames, sMssClampHops);
 
-    setupDns();
+    // The OpenThread task may already be running, and only starts using the context from here on.
+    __atomic_store_n(&sContextReady, true, __ATOMIC_RELEASE);
 }
 
 void netifProcess(otInstance *aInstance)
 {
-    if (sGuardOutput != NULL && xSemaphoreTake(sGuardOutput, portMAX_DELAY) == pdTRUE)
+    NetifContext &context = sContext;
+    uint16_t      packets = 0;
+    uint32_t      bytes   = 0;
+
+    (void)aInstance;
+    VerifyOrExit(__atomic_load_n(&sContextReady, __ATOMIC_ACQUIRE));
+
+#if OTR_CONFIG_NETIF_DIRECT_INPUT
+    inputFlush(context);
+#endif
+    syncAddresses(context);
+
+    while (packets < sTxBudgetPackets && (sTxBudgetBytes == 0 || bytes < sTxBudgetBytes))
+    {
+        uint32_t     enqueueTime;
+        struct pbuf *buffer = outputDequeue(context, enqueueTime);
+
+        if (buffer == NULL)
+        {
+            break;
+        }
+
+        packets++;
+        bytes += buffer->tot_len;
+        processTransmit(context, buffer, enqueueTime);
+    }
+
+    // Yield to tasklets and drivers once the budget is spent, and come back for the rest.
+    if (!outputQueuesAreEmpty(context))
     {
-        processTransmit(aInstance);
-        xSemaphoreGive(sGuardOutput);
+        otrEventSignal(OTR_EVENT_NETIF);
     }
+
+exit:
+    return;
+}
+
+void otrNetifSetTxBudget(uint16_t aPackets, uint32_t aBytes)
+{
+    sTxBudgetPackets = (aPackets > 0) ? aPackets : 1;
+    sTxBudgetBytes   = aBytes;
+}
+
+void otrNetifGetTxBudget(uint16_t *aPackets, uint32_t *aBytes)
+{
+    *aPackets = sTxBudgetPackets;
+    *aBytes   = sTxBudgetBytes;
+}
+
+void otrNetifSetMssClamp(uint8_t aFrames, uint8_t aHops)
+{
+    // lwIP reads the clamp on the tcpip thread when it builds and forwards segments.
+    LOCK_TCPIP_CORE();
+    applyMssClamp(aFrames, aHops);
+    UNLOCK_TCPIP_CORE();
+}
+
+void otrNetifGetMssClamp(uint8_t *aFrames, uint8_t *aHops, uint16_t *aMss)
+{
+    *aFrames = sMssClampFrames;
+    *aHops   = sMssClampHops;
+    *aMss    = sMssClamp;
+}
+
+void otrNetifGetStats(otrNetifStats *aStats)
+{
+    // The queueing counters are updated by lwIP with the core lock held, the rest only on the OpenThread task.
+    LOCK_TCPIP_CORE();
+    *aStats               = sContext.mStats;
+    aStats->mTxQueueDepth = outputQueuesDepth(sContext);
+    aStats->mTcpMssClamped += sContext.mTcpMssClampedRx;
+    UNLOCK_TCPIP_CORE();
+}
+
+void otrNetifResetStats(void)
+{
+    LOCK_TCPIP_CORE();
+    memset(&sContext.mStats, 0, sizeof(sContext.mStats));
+    sContext.mTcpMssClampedRx = 0;
+    UNLOCK_TCPIP_CORE();
 }
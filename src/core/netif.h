@@ -29,13 +29,101 @@
 #ifndef OTX_NETIF_H
 #define OTX_NETIF_H
 
+#include <stdint.h>
+
+#include <openthread/instance.h>
+
+#include "utils/histogram.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * This structure represents the datapath counters of the OpenThread netif.
+ *
+ */
+typedef struct otrNetifStats
+{
+    uint32_t     mTxQueued;         ///< Packets queued by lwIP toward OpenThread.
+    uint32_t     mTxQueueDrops;     ///< Packets pushed back to lwIP because the output queue was full.
+    uint32_t     mTxAllocFailures;  ///< Packets pushed back to lwIP because a pbuf could not be cloned.
+    uint32_t     mTxPackets;        ///< Packets accepted by `otIp6Send`.
+    uint32_t     mTxBytes;          ///< Bytes accepted by `otIp6Send`.
+    uint32_t     mTxSendFailures;   ///< Packets lost because of OpenThread message allocation or send errors.
+    uint32_t     mRxPackets;        ///< Packets delivered to lwIP.
+    uint32_t     mRxBytes;          ///< Bytes delivered to lwIP.
+    uint32_t     mRxAllocFailures;  ///< Packets dropped because no pbuf was available.
+    uint32_t     mRxInputFailures;  ///< Packets rejected by lwIP input.
+    uint32_t     mTcpMssClamped;    ///< TCP SYN segments whose MSS option was lowered, in either direction.
+    uint16_t     mTxQueueDepth;     ///< Packets currently in the output queue.
+    uint16_t     mTxQueueHighWater; ///< Largest output queue depth seen.
+    otrHistogram mTxLatency;        ///< Microseconds from enqueue to `otIp6Send`.
+} otrNetifStats;
+
 void netifInit(void *aContext);
 void netifProcess(otInstance *aInstance);
 
+/**
+ * This function sets how much queued IPv6 traffic `netifProcess` sends to OpenThread per mainloop pass.
+ *
+ * Must be called from the OpenThread task, e.g. from a CLI command or with OT_API_CALL.
+ *
+ * @param[in]  aPackets  Maximum number of packets per pass, at least one packet is always sent.
+ * @param[in]  aBytes    Maximum number of bytes per pass, 0 for no byte limit.
+ *
+ */
+void otrNetifSetTxBudget(uint16_t aPackets, uint32_t aBytes);
+
+/**
+ * This function gets the per-pass transmit budget.
+ *
+ * @param[out]  aPackets  Maximum number of packets per pass.
+ * @param[out]  aBytes    Maximum number of bytes per pass, 0 for no byte limit.
+ *
+ */
+void otrNetifGetTxBudget(uint16_t *aPackets, uint32_t *aBytes);
+
+/**
+ * This function sets the TCP MSS clamping of the netif.
+ *
+ * When enabled, the MSS option of TCP SYN segments crossing the netif, in either direction, is lowered so that a
+ * segment fits in @p aFrames 802.15.4 frames.
+ *
+ * Must be called from the OpenThread task, e.g. from a CLI command or with OT_API_CALL.
+ *
+ * @param[in]  aFrames  The number of frames per TCP segment, 0 to disable clamping.
+ * @param[in]  aHops    The number of mesh hops to account for.
+ *
+ */
+void otrNetifSetMssClamp(uint8_t aFrames, uint8_t aHops);
+
+/**
+ * This function gets the TCP MSS clamping of the netif.
+ *
+ * @param[out]  aFrames  A pointer to where the number of frames per TCP segment is written, 0 when disabled.
+ * @param[out]  aHops    A pointer to where the number of mesh hops is written.
+ * @param[out]  aMss     A pointer to where the resulting MSS is written, 0 when disabled.
+ *
+ */
+void otrNetifGetMssClamp(uint8_t *aFrames, uint8_t *aHops, uint16_t *aMss);
+
+/**
+ * This function gets a copy of the netif datapath counters.
+ *
+ * @param[out]  aStats  A pointer to where the counters are copied.
+ *
+ */
+void otrNetifGetStats(otrNetifStats *aStats);
+
+/**
+ * This function clears the netif datapath counters.
+ *
+ * It must be called on the OpenThread task, which owns the receive side counters.
+ *
+ */
+void otrNetifResetStats(void);
+
 #ifdef __cplusplus
 }
 #endif
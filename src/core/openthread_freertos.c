@@ -30,8 +30,11 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <FreeRTOS.h>
+#include <queue.h>
+#include <semphr.h>
 #include <task.h>
 
 #include <lwip/netdb.h>
@@ -43,18 +46,66 @@
 #include <openthread/diag.h>
 #include <openthread/tasklet.h>
 
+#include <mbedtls/memory_buffer_alloc.h>
 #include <mbedtls/platform.h>
 
 #include "netif.h"
+#include "otr_boot.h"
+#include "otr_config.h"
+#include "otr_profile.h"
+#include "otr_state.h"
 #include "otr_system.h"
 #include "uart_lock.h"
 #include "net/utils/nat64_utils.h"
+#include "utils/lock_stats.h"
+#include "utils/static_alloc.h"
 #include "portable/portable.h"
 
+#define MAIN_TASK_STACK_SIZE 4096
+
 static TaskHandle_t      sMainTask     = NULL;
-static SemaphoreHandle_t sExternalLock = NULL;
+static QueueHandle_t     sCommandQueue = NULL;
+static SemaphoreHandle_t sLockReleased = NULL;
+static volatile bool     sLockHeld     = false; ///< Only written by the OpenThread task.
+static UBaseType_t       sLockHolderPriority;
 static otInstance *      sInstance     = NULL;
+static uint32_t          sLocalEvents  = 0; ///< Events the OpenThread task raised for itself.
+static otrEventStats     sEventStats;
+
+#if OTR_CONFIG_STATIC_ALLOCATION
+static StackType_t       sMainTaskStack[MAIN_TASK_STACK_SIZE] OTR_STATIC_RESERVED;
+static StaticTask_t      sMainTaskBuffer OTR_STATIC_RESERVED;
+static otrCommand *      sCommandQueueStorage[OTR_CONFIG_COMMAND_QUEUE_SIZE] OTR_STATIC_RESERVED;
+static StaticQueue_t     sCommandQueueBuffer OTR_STATIC_RESERVED;
+static StaticSemaphore_t sLockReleasedBuffer OTR_STATIC_RESERVED;
+static unsigned char     sMbedtlsHeap[OTR_CONFIG_STATIC_MBEDTLS_HEAP_SIZE] OTR_STATIC_RESERVED;
+static StackType_t       sIdleTaskStack[configMINIMAL_STACK_SIZE] OTR_STATIC_RESERVED;
+static StaticTask_t      sIdleTaskBuffer OTR_STATIC_RESERVED;
+#if configUSE_TIMERS
+static StackType_t  sTimerTaskStack[configTIMER_TASK_STACK_DEPTH] OTR_STATIC_RESERVED;
+static StaticTask_t sTimerTaskBuffer OTR_STATIC_RESERVED;
+#endif
+
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
+                                   StackType_t ** ppxIdleTaskStackBuffer,
+                                   uint32_t *     pulIdleTaskStackSize)
+{
+    *ppxIdleTaskTCBBuffer   = &sIdleTaskBuffer;
+    *ppxIdleTaskStackBuffer = sIdleTaskStack;
+    *pulIdleTaskStackSize   = configMINIMAL_STACK_SIZE;
+}
 
+#if configUSE_TIMERS
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
+                                    StackType_t ** ppxTimerTaskStackBuffer,
+                                    uint32_t *     pulTimerTaskStackSize)
+{
+    *ppxTimerTaskTCBBuffer   = &sTimerTaskBuffer;
+    *ppxTimerTaskStackBuffer = sTimerTaskStack;
+    *pulTimerTaskStackSize   = configTIMER_TASK_STACK_DEPTH;
+}
+#endif
+#else
 static void *mbedtlsCAlloc(size_t aCount, size_t aSize)
 {
     return calloc(aCount, aSize);
@@ -64,92 +115,387 @@ static void mbedtlsFree(void *aPointer)
 {
     free(aPointer);
 }
+#endif // OTR_CONFIG_STATIC_ALLOCATION
+
+static bool isMainTask(void)
+{
+    return xTaskGetSchedulerState() != taskSCHEDULER_RUNNING || xTaskGetCurrentTaskHandle() == sMainTask;
+}
+
+static void processCommands(void)
+{
+    otrCommand *command;
+
+    while (xQueueReceive(sCommandQueue, &command, 0) == pdTRUE)
+    {
+        // The command may be gone once its handler returns unless someone waits for it.
+        TaskHandle_t waiter = command->mWaiter;
+
+        command->mHandler(command->mContext);
+
+        if (waiter != NULL)
+        {
+            command->mDone = true;
+            xTaskNotify(waiter, OTR_COMMAND_NOTIFY_VALUE, eSetBits);
+        }
+    }
+}
+
+static void waitCommandNotification(void)
+{
+    uint32_t notifyValue = 0;
+
+    while ((notifyValue & OTR_COMMAND_NOTIFY_VALUE) == 0)
+    {
+        xTaskNotifyWait(0, OTR_COMMAND_NOTIFY_VALUE, &notifyValue, portMAX_DELAY);
+    }
+
+    // Other bits may have arrived meanwhile, keep them pending for their own waiters.
+    if ((notifyValue & ~OTR_COMMAND_NOTIFY_VALUE) != 0)
+    {
+        xTaskNotify(xTaskGetCurrentTaskHandle(), 0, eNoAction);
+    }
+}
+
+static uint32_t takeLocalEvents(void)
+{
+    uint32_t events = sLocalEvents;
 
+    sLocalEvents = 0;
+
+    return events;
+}
+
+/**
+ * This function runs the OpenThread task.
+ *
+ * A stage only runs when one of its events was signalled, and events raised by a stage are picked up by the stages
+ * after it in the same pass.
+ *
+ */
 static void mainloop(void *aContext)
 {
-    int         i        = 0;
-    otInstance *instance = (otInstance *)aContext;
+    (void)aContext;
 
-    otrSystemProcess(instance);
-    xSemaphoreTake(sExternalLock, portMAX_DELAY);
+    const uint32_t kEarlyEvents = OTR_EVENT_BIT(OTR_EVENT_COMMAND) | OTR_EVENT_BIT(OTR_EVENT_TASKLET) |
+                                  OTR_EVENT_BIT(OTR_EVENT_API_CALL);
+    const uint32_t kLateEvents  = OTR_EVENT_BIT(OTR_EVENT_DRIVER) | OTR_EVENT_BIT(OTR_EVENT_NETIF);
+    uint32_t       events       = kEarlyEvents | kLateEvents;
+    uint32_t       stageStart;
+    bool           pending;
+
+    otrBootMark(OTR_BOOT_PHASE_MAINLOOP);
     while (!otSysPseudoResetWasRequested())
     {
-        otTaskletsProcess(instance);
-        xSemaphoreGive(sExternalLock);
-        otrSystemPoll(instance);
-        xSemaphoreTake(sExternalLock, portMAX_DELAY);
-        otrSystemProcess(instance);
-        netifProcess(instance);
+        if (events & OTR_EVENT_BIT(OTR_EVENT_COMMAND))
+        {
+            OTR_PROFILE_START(stageStart);
+            processCommands();
+            OTR_PROFILE_END(OTR_PROFILE_STAGE_COMMANDS, stageStart);
+        }
+        events |= takeLocalEvents();
+
+        if (events & (OTR_EVENT_BIT(OTR_EVENT_TASKLET) | OTR_EVENT_BIT(OTR_EVENT_API_CALL)))
+        {
+            OTR_PROFILE_START(stageStart);
+            otTaskletsProcess(sInstance);
+            OTR_PROFILE_END(OTR_PROFILE_STAGE_TASKLETS, stageStart);
+        }
+        events = (events & kLateEvents) | takeLocalEvents();
+
+        if (otTaskletsArePending(sInstance))
+        {
+            events |= OTR_EVENT_BIT(OTR_EVENT_TASKLET);
+        }
+
+        pending = (events != 0);
+
+        OTR_PROFILE_START(stageStart);
+        events |= otrSystemPoll(pending);
+        OTR_PROFILE_END(OTR_PROFILE_STAGE_POLL, stageStart);
+#if OTR_CONFIG_MAINLOOP_PROFILE
+        otrProfileWakeupServiced();
+#endif
+        if (!pending)
+        {
+            sEventStats.mWakeups++;
+        }
+
+        if (events & OTR_EVENT_BIT(OTR_EVENT_DRIVER))
+        {
+            OTR_PROFILE_START(stageStart);
+            otrSystemProcess(sInstance);
+            OTR_PROFILE_END(OTR_PROFILE_STAGE_SYSTEM_PROCESS, stageStart);
+        }
+        events |= takeLocalEvents();
+
+        if (events & OTR_EVENT_BIT(OTR_EVENT_NETIF))
+        {
+            OTR_PROFILE_START(stageStart);
+            netifProcess(sInstance);
+            OTR_PROFILE_END(OTR_PROFILE_STAGE_NETIF, stageStart);
+        }
+        events = (events & kEarlyEvents) | takeLocalEvents();
     }
 
-    otInstanceFinalize(instance);
+    otInstanceFinalize(sInstance);
     vTaskDelete(NULL);
 }
 
-void otrTaskNotifyGive()
+static void netifInitDone(void *aContext)
+{
+    netifInit(aContext);
+    otrBootMark(OTR_BOOT_PHASE_NETIF);
+}
+
+void otrEventSignal(otrEvent aEvent)
 {
-#if !PLATFORM_linux // linux use select rather than event notification
-    xTaskNotifyGive(sMainTask);
+    __atomic_fetch_add(&sEventStats.mSignals[aEvent], 1, __ATOMIC_RELAXED);
+
+    if (isMainTask())
+    {
+        // Picked up by the next stage of the current pass, without a kernel call.
+        sLocalEvents |= OTR_EVENT_BIT(aEvent);
+    }
+    else
+    {
+#if OTR_CONFIG_MAINLOOP_PROFILE
+        otrProfileWakeup();
+#endif
+        xTaskNotify(sMainTask, OTR_EVENT_BIT(aEvent), eSetBits);
+#if PLATFORM_linux && !OTR_CONFIG_VIRTUAL_TIME // linux waits in select rather than on the task notification
+        otrSystemWakeup();
 #endif
+    }
 }
 
-void otrTaskNotifyGiveFromISR()
+void otrEventSignalFromISR(otrEvent aEvent)
 {
-#if !PLATFORM_linux // linux use select rather than event notification
-    BaseType_t taskWoken;
+    BaseType_t taskWoken = pdFALSE;
+
+    __atomic_fetch_add(&sEventStats.mSignals[aEvent], 1, __ATOMIC_RELAXED);
 
-    vTaskNotifyGiveFromISR(sMainTask, &taskWoken);
+#if OTR_CONFIG_MAINLOOP_PROFILE
+    otrProfileWakeup();
 #endif
+    xTaskNotifyFromISR(sMainTask, OTR_EVENT_BIT(aEvent), eSetBits, &taskWoken);
+#if PLATFORM_linux && !OTR_CONFIG_VIRTUAL_TIME
+    otrSystemWakeup();
+#endif
+    portYIELD_FROM_ISR(taskWoken);
+}
+
+void otrTaskNotifyGive(void)
+{
+    otrEventSignal(OTR_EVENT_DRIVER);
+}
+
+void otrTaskNotifyGiveFromISR(void)
+{
+    otrEventSignalFromISR(OTR_EVENT_DRIVER);
+}
+
+void otrEventGetStats(otrEventStats *aStats)
+{
+    *aStats = sEventStats;
+}
+
+void otrEventResetStats(void)
+{
+    memset(&sEventStats, 0, sizeof(sEventStats));
+}
+
+const char *otrEventName(otrEvent aEvent)
+{
+    static const char *const kNames[OTR_NUM_EVENTS] = {
+        "command", "tasklet", "driver", "netif", "api call",
+    };
+
+    return (aEvent < OTR_NUM_EVENTS) ? kNames[aEvent] : "unknown";
 }
 
 void otTaskletsSignalPending(otInstance *aInstance)
 {
     (void)aInstance;
-    otrTaskNotifyGive();
-    // TODO aInstance != sInstance
-    // assert(aInstance == sInstance);
+    otrEventSignal(OTR_EVENT_TASKLET);
 }
 
 void otrInit(int argc, char *argv[])
 {
+    otError error;
+
+    otrBootMark(OTR_BOOT_PHASE_INIT);
+
+#if OTR_CONFIG_STATIC_ALLOCATION
+    mbedtls_memory_buffer_alloc_init(sMbedtlsHeap, sizeof(sMbedtlsHeap));
+#else
     mbedtls_platform_set_calloc_free(mbedtlsCAlloc, mbedtlsFree);
+#endif
 
     otrUartLockInit();
     otSysInit(argc, argv);
+    otrSystemInit();
+    otrBootMark(OTR_BOOT_PHASE_SYSTEM);
 
     sInstance = otInstanceInitSingle();
     assert(sInstance);
 
+    error = otrStateInit(sInstance);
+    assert(error == OT_ERROR_NONE);
+    (void)error;
+    otrBootMark(OTR_BOOT_PHASE_INSTANCES);
+
 #if OPENTHREAD_ENABLE_DIAG
     otDiagInit(sInstance);
 #endif
-    tcpip_init(netifInit, sInstance);
+    // The interfaces are added by the TCPIP thread once the scheduler runs, off the boot critical path.
+    tcpip_init(netifInitDone, sInstance);
+    otrBootMark(OTR_BOOT_PHASE_TCPIP);
 
-    sExternalLock = xSemaphoreCreateMutex();
-    assert(sExternalLock != NULL);
+#if OTR_CONFIG_STATIC_ALLOCATION
+    sCommandQueue = xQueueCreateStatic(OTR_CONFIG_COMMAND_QUEUE_SIZE, sizeof(otrCommand *),
+                                       (uint8_t *)sCommandQueueStorage, &sCommandQueueBuffer);
+    sLockReleased = xSemaphoreCreateBinaryStatic(&sLockReleasedBuffer);
+#else
+    sCommandQueue = xQueueCreate(OTR_CONFIG_COMMAND_QUEUE_SIZE, sizeof(otrCommand *));
+    assert(sCommandQueue != NULL);
+
+    sLockReleased = xSemaphoreCreateBinary();
+    assert(sLockReleased != NULL);
+#endif
 }
 
 void otrStart(void)
 {
-    xTaskCreate(mainloop, "ot", 4096, sInstance, 2, &sMainTask);
+    otrBootMark(OTR_BOOT_PHASE_SCHEDULER);
+
+#if OTR_CONFIG_STATIC_ALLOCATION
+    sMainTask = xTaskCreateStatic(mainloop, "ot", MAIN_TASK_STACK_SIZE, NULL, 2, sMainTaskStack, &sMainTaskBuffer);
+#else
+    xTaskCreate(mainloop, "ot", MAIN_TASK_STACK_SIZE, NULL, 2, &sMainTask);
+#endif
     // Activate deep sleep mode
     OTR_PORT_ENABLE_SLEEP();
     vTaskStartScheduler();
 }
 
+static void commandSend(otrCommand *aCommand)
+{
+    xQueueSend(sCommandQueue, &aCommand, portMAX_DELAY);
+    otrEventSignal(OTR_EVENT_COMMAND);
+}
+
+otError otrCommandPost(otrCommand *aCommand)
+{
+    otError error = OT_ERROR_NONE;
+
+    aCommand->mDone = false;
+
+    if (xQueueSend(sCommandQueue, &aCommand, 0) == pdTRUE)
+    {
+        otrEventSignal(OTR_EVENT_COMMAND);
+    }
+    else
+    {
+        error = OT_ERROR_NO_BUFS;
+    }
+
+    return error;
+}
+
+void otrCommandWait(otrCommand *aCommand)
+{
+    assert(aCommand->mWaiter == xTaskGetCurrentTaskHandle());
+
+    // Each waited command is notified exactly once, consume that notification even if it is already done.
+    waitCommandNotification();
+    assert(aCommand->mDone);
+}
+
+void otrCommandCall(otrCommandHandler aHandler, void *aContext)
+{
+    otrCommand command;
+
+    if (isMainTask())
+    {
+        aHandler(aContext);
+    }
+    else
+    {
+        command.mHandler = aHandler;
+        command.mContext = aContext;
+        command.mWaiter  = xTaskGetCurrentTaskHandle();
+        command.mDone    = false;
+
+        commandSend(&command);
+        otrCommandWait(&command);
+    }
+}
+
+/**
+ * This function parks the OpenThread task until the task holding the API lock calls `otrUnlock`.
+ *
+ * Like a mutex, the holder inherits the priority of the OpenThread task while it holds the lock, so a lower priority
+ * holder cannot be preempted indefinitely while the stack waits for it. `otrUnlock` restores its priority.
+ *
+ */
+static void lockHandler(void *aContext)
+{
+    TaskHandle_t holder = (TaskHandle_t)aContext;
+    UBaseType_t  priority;
+    uint32_t     holdStart;
+
+    sLockHolderPriority = uxTaskPriorityGet(holder);
+    priority            = uxTaskPriorityGet(NULL);
+    if (sLockHolderPriority < priority)
+    {
+        vTaskPrioritySet(holder, priority);
+    }
+
+    sLockHeld = true;
+    OTR_PROFILE_START(holdStart);
+    xTaskNotify(holder, OTR_COMMAND_NOTIFY_VALUE, eSetBits);
+    xSemaphoreTake(sLockReleased, portMAX_DELAY);
+    OTR_PROFILE_END(OTR_PROFILE_STAGE_LOCK_HOLD, holdStart);
+    sLockHeld = false;
+}
+
 void otrLock(void)
 {
-    if (xTaskGetCurrentTaskHandle() != sMainTask)
+    // Without a waiter the executor leaves the command alone once the handler runs, so it can live on this stack.
+    otrCommand command;
+    uint32_t   waitStart;
+    uint32_t   statsWaitStart;
+    bool       contended;
+
+    if (!isMainTask())
     {
-        xSemaphoreTake(sExternalLock, portMAX_DELAY);
+        command.mHandler = lockHandler;
+        command.mContext = xTaskGetCurrentTaskHandle();
+        command.mWaiter  = NULL;
+        command.mDone    = false;
+
+        OTR_PROFILE_START(waitStart);
+        statsWaitStart = otrLockStatsWaitBegin();
+        contended      = sLockHeld;
+        commandSend(&command);
+        waitCommandNotification();
+        // Recorded while holding the lock, so lock holders never record at once.
+        OTR_PROFILE_END(OTR_PROFILE_STAGE_LOCK_WAIT, waitStart);
+        otrLockStatsAcquired(OTR_LOCK_STATS_OPENTHREAD, sLockReleased, statsWaitStart, contended);
     }
 }
 
 void otrUnlock(void)
 {
-    if (xTaskGetCurrentTaskHandle() != sMainTask)
+    if (!isMainTask())
     {
-        xSemaphoreGive(sExternalLock);
+        // Read before releasing, the next holder overwrites it.
+        UBaseType_t priority = sLockHolderPriority;
+
+        otrLockStatsReleased(OTR_LOCK_STATS_OPENTHREAD, sLockReleased);
+        xSemaphoreGive(sLockReleased);
+        vTaskPrioritySet(NULL, priority);
     }
 }
 
@@ -157,11 +503,11 @@ void otSysEventSignalPending(void)
 {
     if (otrPortIsInsideInterrupt())
     {
-        otrTaskNotifyGiveFromISR();
+        otrEventSignalFromISR(OTR_EVENT_DRIVER);
     }
     else
     {
-        otrTaskNotifyGive();
+        otrEventSignal(OTR_EVENT_DRIVER);
     }
 }
 
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2020, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the boot profiler.
+ *
+ */
+
+#include "otr_boot.h"
+
+#include "utils/time_utils.h"
+
+static uint64_t sInitTime;
+static uint32_t sTimes[OTR_BOOT_NUM_PHASES];
+static uint32_t sReached = 0;
+
+void otrBootMark(otrBootPhase aPhase)
+{
+    uint32_t mask = 1UL << aPhase;
+
+    if (aPhase == OTR_BOOT_PHASE_INIT)
+    {
+        sInitTime = otrTimeGetUs();
+    }
+
+    if ((__atomic_load_n(&sReached, __ATOMIC_ACQUIRE) & mask) == 0)
+    {
+        sTimes[aPhase] = (uint32_t)(otrTimeGetUs() - sInitTime);
+
+        // Each phase is only marked from one context, so the check above cannot race with another writer.
+        __atomic_fetch_or(&sReached, mask, __ATOMIC_RELEASE);
+    }
+}
+
+bool otrBootGetTime(otrBootPhase aPhase, uint32_t *aTimeUs)
+{
+    bool reached = (aPhase < OTR_BOOT_NUM_PHASES) && (__atomic_load_n(&sReached, __ATOMIC_ACQUIRE) & (1UL << aPhase));
+
+    if (reached)
+    {
+        *aTimeUs = sTimes[aPhase];
+    }
+
+    return reached;
+}
+
+const char *otrBootPhaseName(otrBootPhase aPhase)
+{
+    static const char *const kNames[OTR_BOOT_NUM_PHASES] = {
+        "init", "system", "instances", "tcpip", "scheduler", "mainloop", "netif", "netif up", "attached",
+    };
+
+    return (aPhase < OTR_BOOT_NUM_PHASES) ? kNames[aPhase] : "unknown";
+}
@@ -0,0 +1,99 @@
+/*
+ *  Copyright (c) 2020, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions of the boot profiler.
+ *
+ */
+
+#ifndef OT_FREERTOS_BOOT_H_
+#define OT_FREERTOS_BOOT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * This enumeration defines the boot phases, in the order they are normally reached.
+ *
+ */
+typedef enum otrBootPhase
+{
+    OTR_BOOT_PHASE_INIT,      ///< `otrInit` entered, the origin of all boot times.
+    OTR_BOOT_PHASE_SYSTEM,    ///< Platform drivers initialized by `otSysInit`.
+    OTR_BOOT_PHASE_INSTANCES, ///< OpenThread instances initialized.
+    OTR_BOOT_PHASE_TCPIP,     ///< lwIP initialized, its TCPIP thread created.
+    OTR_BOOT_PHASE_SCHEDULER, ///< FreeRTOS scheduler starting, after the application initialized.
+    OTR_BOOT_PHASE_MAINLOOP,  ///< OpenThread task running.
+    OTR_BOOT_PHASE_NETIF,     ///< lwIP interfaces added by the TCPIP thread.
+    OTR_BOOT_PHASE_NETIF_UP,  ///< First interface up.
+    OTR_BOOT_PHASE_ATTACHED,  ///< First instance attached to a Thread network.
+    OTR_BOOT_NUM_PHASES,
+} otrBootPhase;
+
+/**
+ * This function records that a boot phase was reached.
+ *
+ * Only the first call for each phase is recorded, timed with `otrTimeGetUs` from `OTR_BOOT_PHASE_INIT`.
+ *
+ * @param[in]  aPhase  The phase.
+ *
+ */
+void otrBootMark(otrBootPhase aPhase);
+
+/**
+ * This function gets the time a boot phase was reached.
+ *
+ * @param[in]   aPhase   The phase.
+ * @param[out]  aTimeUs  A pointer to where to store the time since `OTR_BOOT_PHASE_INIT`, in microseconds.
+ *
+ * @retval true   @p aPhase was reached and @p aTimeUs is set.
+ * @retval false  @p aPhase was not reached yet.
+ *
+ */
+bool otrBootGetTime(otrBootPhase aPhase, uint32_t *aTimeUs);
+
+/**
+ * This function returns the name of a boot phase.
+ *
+ * @param[in]  aPhase  The phase.
+ *
+ * @returns The name of @p aPhase.
+ *
+ */
+const char *otrBootPhaseName(otrBootPhase aPhase);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OT_FREERTOS_BOOT_H_
@@ -0,0 +1,369 @@
+/*
+ *  Copyright (c) 2020, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes compile-time configuration constants for OpenThread RTOS.
+ *
+ *   Each constant can be overridden by a compile definition or by the project header named by
+ *   `OTR_PROJECT_CONFIG_FILE`.
+ *
+ */
+
+#ifndef OT_FREERTOS_CONFIG_H_
+#define OT_FREERTOS_CONFIG_H_
+
+#ifdef OTR_PROJECT_CONFIG_FILE
+#include OTR_PROJECT_CONFIG_FILE
+#endif
+
+/**
+ * @def OTR_CONFIG_COMMAND_QUEUE_SIZE
+ *
+ * The number of commands that can be queued to the OpenThread task.
+ *
+ */
+#ifndef OTR_CONFIG_COMMAND_QUEUE_SIZE
+#define OTR_CONFIG_COMMAND_QUEUE_SIZE 8
+#endif
+
+/**
+ * @def OTR_CONFIG_STATE_MAX_ADDRESSES
+ *
+ * The number of unicast addresses kept in the OpenThread state snapshot.
+ *
+ */
+#ifndef OTR_CONFIG_STATE_MAX_ADDRESSES
+#define OTR_CONFIG_STATE_MAX_ADDRESSES 8
+#endif
+
+/**
+ * @def OTR_CONFIG_NETIF_OUTPUT_QUEUE_SIZE
+ *
+ * The number of IPv6 packets lwIP may queue toward OpenThread per egress priority class. Must be a power of two.
+ *
+ */
+#ifndef OTR_CONFIG_NETIF_OUTPUT_QUEUE_SIZE
+#define OTR_CONFIG_NETIF_OUTPUT_QUEUE_SIZE 16
+#endif
+
+/**
+ * @def OTR_CONFIG_NETIF_EGRESS_STRICT_PRIORITY
+ *
+ * Define as 1 to always send higher egress priority classes first, instead of weighted round-robin.
+ *
+ */
+#ifndef OTR_CONFIG_NETIF_EGRESS_STRICT_PRIORITY
+#define OTR_CONFIG_NETIF_EGRESS_STRICT_PRIORITY 0
+#endif
+
+/**
+ * @def OTR_CONFIG_NETIF_EGRESS_WEIGHT_HIGH
+ *
+ * The weighted round-robin share of the high egress priority class (network control, ACKs, DNS, EF).
+ *
+ */
+#ifndef OTR_CONFIG_NETIF_EGRESS_WEIGHT_HIGH
+#define OTR_CONFIG_NETIF_EGRESS_WEIGHT_HIGH 8
+#endif
+
+/**
+ * @def OTR_CONFIG_NETIF_EGRESS_WEIGHT_NORMAL
+ *
+ * The weighted round-robin share of the normal egress priority class (unmarked traffic).
+ *
+ */
+#ifndef OTR_CONFIG_NETIF_EGRESS_WEIGHT_NORMAL
+#define OTR_CONFIG_NETIF_EGRESS_WEIGHT_NORMAL 4
+#endif
+
+/**
+ * @def OTR_CONFIG_NETIF_EGRESS_WEIGHT_LOW
+ *
+ * The weighted round-robin share of the low egress priority class (traffic marked CS1 or LE).
+ *
+ */
+#ifndef OTR_CONFIG_NETIF_EGRESS_WEIGHT_LOW
+#define OTR_CONFIG_NETIF_EGRESS_WEIGHT_LOW 1
+#endif
+
+/**
+ * @def OTR_CONFIG_NETIF_TX_BUDGET_PACKETS
+ *
+ * The default number of queued IPv6 packets sent to OpenThread per mainloop pass.
+ *
+ */
+#ifndef OTR_CONFIG_NETIF_TX_BUDGET_PACKETS
+#define OTR_CONFIG_NETIF_TX_BUDGET_PACKETS 4
+#endif
+
+/**
+ * @def OTR_CONFIG_NETIF_TX_BUDGET_BYTES
+ *
+ * The default number of queued IPv6 bytes sent to OpenThread per mainloop pass, 0 for no byte limit.
+ *
+ */
+#ifndef OTR_CONFIG_NETIF_TX_BUDGET_BYTES
+#define OTR_CONFIG_NETIF_TX_BUDGET_BYTES 0
+#endif
+
+/**
+ * @def OTR_CONFIG_NETIF_MSS_CLAMP_FRAMES
+ *
+ * The default number of 802.15.4 frames a TCP segment is clamped to, 0 to disable TCP MSS clamping.
+ *
+ */
+#ifndef OTR_CONFIG_NETIF_MSS_CLAMP_FRAMES
+#define OTR_CONFIG_NETIF_MSS_CLAMP_FRAMES 0
+#endif
+
+/**
+ * @def OTR_CONFIG_NETIF_MSS_CLAMP_HOPS
+ *
+ * The default number of mesh hops accounted for by TCP MSS clamping.
+ *
+ */
+#ifndef OTR_CONFIG_NETIF_MSS_CLAMP_HOPS
+#define OTR_CONFIG_NETIF_MSS_CLAMP_HOPS 1
+#endif
+
+/**
+ * @def OTR_CONFIG_NETIF_MAX_UNICAST_ADDRESSES
+ *
+ * The number of OpenThread unicast addresses considered when synchronizing the lwIP netif. lwIP itself only holds
+ * `LWIP_IPV6_NUM_ADDRESSES` of them.
+ *
+ */
+#ifndef OTR_CONFIG_NETIF_MAX_UNICAST_ADDRESSES
+#define OTR_CONFIG_NETIF_MAX_UNICAST_ADDRESSES 16
+#endif
+
+/**
+ * @def OTR_CONFIG_NETIF_MAX_MULTICAST_ADDRESSES
+ *
+ * The number of OpenThread multicast addresses joined on the lwIP netif.
+ *
+ */
+#ifndef OTR_CONFIG_NETIF_MAX_MULTICAST_ADDRESSES
+#define OTR_CONFIG_NETIF_MAX_MULTICAST_ADDRESSES 16
+#endif
+
+/**
+ * @def OTR_CONFIG_NETIF_DIRECT_INPUT
+ *
+ * Define as 1 to pass received IPv6 packets to `ip6_input` from the OpenThread task under the TCPIP core lock,
+ * instead of posting each one to the TCPIP thread mailbox with `tcpip_input`.
+ *
+ */
+#ifndef OTR_CONFIG_NETIF_DIRECT_INPUT
+#define OTR_CONFIG_NETIF_DIRECT_INPUT 0
+#endif
+
+/**
+ * @def OTR_CONFIG_NETIF_RX_BATCH_SIZE
+ *
+ * The number of received IPv6 packets passed to lwIP per TCPIP core lock acquisition when
+ * `OTR_CONFIG_NETIF_DIRECT_INPUT` is enabled.
+ *
+ */
+#ifndef OTR_CONFIG_NETIF_RX_BATCH_SIZE
+#define OTR_CONFIG_NETIF_RX_BATCH_SIZE 8
+#endif
+
+/**
+ * @def OTR_CONFIG_MAINLOOP_PROFILE
+ *
+ * Define as 1 to record the duration of each OpenThread mainloop stage, the API lock wait and hold times and the
+ * wakeup-to-service latency in histograms, read with `otrProfileGetStats`.
+ *
+ */
+#ifndef OTR_CONFIG_MAINLOOP_PROFILE
+#define OTR_CONFIG_MAINLOOP_PROFILE 0
+#endif
+
+/**
+ * @def OTR_CONFIG_VIRTUAL_TIME
+ *
+ * Define as 1 on Linux to run on OpenThread's simulated clock. Time only advances once every task is blocked, and the
+ * FreeRTOS tick, and with it lwIP `sys_now`, follows the OpenThread alarm. Requires OpenThread built with
+ * `VIRTUAL_TIME=1` and a virtual time simulator.
+ *
+ */
+#ifndef OTR_CONFIG_VIRTUAL_TIME
+#define OTR_CONFIG_VIRTUAL_TIME 0
+#endif
+
+/**
+ * @def OTR_CONFIG_LINUX_EPOLL
+ *
+ * Define as 1 for the Linux OpenThread task to wait with epoll, or as 0 to wait with select.
+ *
+ * epoll keeps edge-triggered registrations across passes and only hands the drivers the descriptors it reported, so a
+ * pass neither copies descriptor sets into the kernel nor scans them. select only handles descriptors below
+ * `FD_SETSIZE` and is kept for hosts and debugging sessions without epoll.
+ *
+ */
+#ifndef OTR_CONFIG_LINUX_EPOLL
+#define OTR_CONFIG_LINUX_EPOLL 1
+#endif
+
+/**
+ * @def OTR_CONFIG_LINUX_EPOLL_EVENTS
+ *
+ * The number of ready descriptors collected by one epoll wait.
+ *
+ */
+#ifndef OTR_CONFIG_LINUX_EPOLL_EVENTS
+#define OTR_CONFIG_LINUX_EPOLL_EVENTS 8
+#endif
+
+/**
+ * @def OTR_CONFIG_LINUX_EPOLL_MAX_FDS
+ *
+ * The number of driver descriptors that can be registered with epoll at once, including the wakeup pipe.
+ *
+ */
+#ifndef OTR_CONFIG_LINUX_EPOLL_MAX_FDS
+#define OTR_CONFIG_LINUX_EPOLL_MAX_FDS 8
+#endif
+
+/**
+ * @def OTR_CONFIG_LOCK_STATS
+ *
+ * Define as 1 to record acquisitions, contention, wait and hold times of the OpenThread API lock and the lwIP mutexes,
+ * read with `otrLockStatsGet`.
+ *
+ */
+#ifndef OTR_CONFIG_LOCK_STATS
+#define OTR_CONFIG_LOCK_STATS 0
+#endif
+
+/**
+ * @def OTR_CONFIG_LOCK_STATS_MAX_TASKS
+ *
+ * The number of tasks whose lock usage is recorded separately when `OTR_CONFIG_LOCK_STATS` is enabled.
+ *
+ */
+#ifndef OTR_CONFIG_LOCK_STATS_MAX_TASKS
+#define OTR_CONFIG_LOCK_STATS_MAX_TASKS 8
+#endif
+
+/**
+ * @def OTR_CONFIG_LOCK_STATS_MAX_HELD
+ *
+ * The number of locks held at once whose hold time is recorded when `OTR_CONFIG_LOCK_STATS` is enabled.
+ *
+ */
+#ifndef OTR_CONFIG_LOCK_STATS_MAX_HELD
+#define OTR_CONFIG_LOCK_STATS_MAX_HELD 8
+#endif
+
+/**
+ * @def OTR_CONFIG_WORKER_POOL_SIZE
+ *
+ * The number of worker tasks created by `otrWorkerInit`.
+ *
+ */
+#ifndef OTR_CONFIG_WORKER_POOL_SIZE
+#define OTR_CONFIG_WORKER_POOL_SIZE 2
+#endif
+
+/**
+ * @def OTR_CONFIG_WORKER_STACK_SIZE
+ *
+ * The stack size of each worker task, in words.
+ *
+ */
+#ifndef OTR_CONFIG_WORKER_STACK_SIZE
+#define OTR_CONFIG_WORKER_STACK_SIZE 3000
+#endif
+
+/**
+ * @def OTR_CONFIG_WORKER_PRIORITY
+ *
+ * The priority of the worker tasks.
+ *
+ */
+#ifndef OTR_CONFIG_WORKER_PRIORITY
+#define OTR_CONFIG_WORKER_PRIORITY 2
+#endif
+
+/**
+ * @def OTR_CONFIG_STATIC_ALLOCATION
+ *
+ * Define as 1 to create the runtime tasks, queues, semaphores and mutexes, including those of the lwIP port, from
+ * statically reserved memory, and to serve mbedTLS from a static heap. Runtime kernel objects then never come from
+ * the heap, and the pools below bound how many lwIP objects can exist at once.
+ *
+ */
+#ifndef OTR_CONFIG_STATIC_ALLOCATION
+#define OTR_CONFIG_STATIC_ALLOCATION 0
+#endif
+
+/**
+ * @def OTR_CONFIG_STATIC_LWIP_SEMAPHORES
+ *
+ * The number of lwIP semaphores that can exist at once with `OTR_CONFIG_STATIC_ALLOCATION`.
+ *
+ */
+#ifndef OTR_CONFIG_STATIC_LWIP_SEMAPHORES
+#define OTR_CONFIG_STATIC_LWIP_SEMAPHORES 8
+#endif
+
+/**
+ * @def OTR_CONFIG_STATIC_LWIP_MUTEXES
+ *
+ * The number of lwIP mutexes that can exist at once with `OTR_CONFIG_STATIC_ALLOCATION`.
+ *
+ */
+#ifndef OTR_CONFIG_STATIC_LWIP_MUTEXES
+#define OTR_CONFIG_STATIC_LWIP_MUTEXES 4
+#endif
+
+/**
+ * @def OTR_CONFIG_STATIC_LWIP_MBOXES
+ *
+ * The number of lwIP connection mailboxes that can exist at once with `OTR_CONFIG_STATIC_ALLOCATION`, in addition to
+ * the TCPIP thread mailbox.
+ *
+ */
+#ifndef OTR_CONFIG_STATIC_LWIP_MBOXES
+#define OTR_CONFIG_STATIC_LWIP_MBOXES 8
+#endif
+
+/**
+ * @def OTR_CONFIG_STATIC_MBEDTLS_HEAP_SIZE
+ *
+ * The size in bytes of the static mbedTLS heap with `OTR_CONFIG_STATIC_ALLOCATION`.
+ *
+ */
+#ifndef OTR_CONFIG_STATIC_MBEDTLS_HEAP_SIZE
+#define OTR_CONFIG_STATIC_MBEDTLS_HEAP_SIZE 32768
+#endif
+
+#endif // OT_FREERTOS_CONFIG_H_
@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2020, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "otr_profile.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+static otrProfileStats sStats;
+static volatile bool   sWakeupPending = false;
+static uint32_t        sWakeupTimestamp;
+
+void otrProfileRecord(otrProfileStage aStage, uint32_t aStart)
+{
+    // Unsigned subtraction stays correct across one wrap of the timestamp, every 71 minutes.
+    otrHistogramAdd(&sStats.mStages[aStage], (uint32_t)otrTimeGetUs() - aStart);
+}
+
+void otrProfileWakeup(void)
+{
+    // Racing signals may both stamp, which only moves the start by a few cycles.
+    if (!sWakeupPending)
+    {
+        sWakeupTimestamp = (uint32_t)otrTimeGetUs();
+        sWakeupPending   = true;
+    }
+}
+
+void otrProfileWakeupServiced(void)
+{
+    if (sWakeupPending)
+    {
+        otrProfileRecord(OTR_PROFILE_STAGE_WAKEUP, sWakeupTimestamp);
+        sWakeupPending = false;
+    }
+}
+
+otError otrProfileGetStats(otrProfileStats *aStats)
+{
+    otError error = OT_ERROR_NONE;
+
+#if OTR_CONFIG_MAINLOOP_PROFILE
+    *aStats = sStats;
+#else
+    (void)aStats;
+    error = OT_ERROR_NOT_IMPLEMENTED;
+#endif
+
+    return error;
+}
+
+void otrProfileResetStats(void)
+{
+    memset(&sStats, 0, sizeof(sStats));
+}
+
+const char *otrProfileStageName(otrProfileStage aStage)
+{
+    static const char *const kNames[OTR_PROFILE_NUM_STAGES] = {
+        "commands", "tasklets", "poll", "system", "netif", "lock wait", "lock hold", "wakeup",
+    };
+
+    return (aStage < OTR_PROFILE_NUM_STAGES) ? kNames[aStage] : "unknown";
+}
@@ -0,0 +1,155 @@
+/*
+ *  Copyright (c) 2020, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions of the OpenThread mainloop profiler.
+ *
+ */
+
+#ifndef OT_FREERTOS_PROFILE_H_
+#define OT_FREERTOS_PROFILE_H_
+
+#include <stdint.h>
+
+#include <openthread/error.h>
+
+#include "otr_config.h"
+#include "utils/histogram.h"
+#include "utils/time_utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * This enumeration defines the profiled stages, all recorded in microseconds.
+ *
+ */
+typedef enum otrProfileStage
+{
+    OTR_PROFILE_STAGE_COMMANDS,       ///< Running queued commands, including the time parked for the API lock.
+    OTR_PROFILE_STAGE_TASKLETS,       ///< `otTaskletsProcess`.
+    OTR_PROFILE_STAGE_POLL,           ///< `otrSystemPoll`, including the time spent idle.
+    OTR_PROFILE_STAGE_SYSTEM_PROCESS, ///< `otrSystemProcess`.
+    OTR_PROFILE_STAGE_NETIF,          ///< `netifProcess`.
+    OTR_PROFILE_STAGE_LOCK_WAIT,      ///< From `otrLock` until the OpenThread task parks for the caller.
+    OTR_PROFILE_STAGE_LOCK_HOLD,      ///< From the OpenThread task parking until `otrUnlock`.
+    OTR_PROFILE_STAGE_WAKEUP,         ///< From the first wakeup signal until `otrSystemPoll` returns.
+    OTR_PROFILE_NUM_STAGES,
+} otrProfileStage;
+
+/**
+ * This structure represents the mainloop profile.
+ *
+ */
+typedef struct otrProfileStats
+{
+    otrHistogram mStages[OTR_PROFILE_NUM_STAGES]; ///< Durations in microseconds, indexed by `otrProfileStage`.
+} otrProfileStats;
+
+#if OTR_CONFIG_MAINLOOP_PROFILE
+
+/**
+ * This macro stores the start timestamp of a stage in @p aStart.
+ *
+ * The timestamp is the low 32 bits of `otrTimeGetUs`, which keeps running while the CPU sleeps in the poll stage.
+ *
+ */
+#define OTR_PROFILE_START(aStart) ((aStart) = (uint32_t)otrTimeGetUs())
+
+/**
+ * This macro records the time elapsed since @p aStart for @p aStage.
+ *
+ */
+#define OTR_PROFILE_END(aStage, aStart) otrProfileRecord((aStage), (aStart))
+
+#else
+
+#define OTR_PROFILE_START(aStart) ((void)(aStart))
+#define OTR_PROFILE_END(aStage, aStart) ((void)(aStart))
+
+#endif
+
+/**
+ * This function records a stage duration.
+ *
+ * Samples of one stage must not be recorded by two tasks at once.
+ *
+ * @param[in]  aStage  The stage.
+ * @param[in]  aStart  The timestamp taken with `OTR_PROFILE_START` when the stage started.
+ *
+ */
+void otrProfileRecord(otrProfileStage aStage, uint32_t aStart);
+
+/**
+ * This function notes a wakeup signal to the OpenThread task, callable from interrupts.
+ *
+ * Only the first signal before the OpenThread task is serviced is timed.
+ *
+ */
+void otrProfileWakeup(void);
+
+/**
+ * This function records the wakeup-to-service latency, if a wakeup signal is pending.
+ *
+ */
+void otrProfileWakeupServiced(void);
+
+/**
+ * This function gets the mainloop profile.
+ *
+ * @param[out]  aStats  A pointer to where to copy the profile.
+ *
+ * @retval OT_ERROR_NONE             Successfully copied the profile.
+ * @retval OT_ERROR_NOT_IMPLEMENTED  `OTR_CONFIG_MAINLOOP_PROFILE` is disabled.
+ *
+ */
+otError otrProfileGetStats(otrProfileStats *aStats);
+
+/**
+ * This function clears the mainloop profile.
+ *
+ */
+void otrProfileResetStats(void);
+
+/**
+ * This function returns the name of a stage.
+ *
+ * @param[in]  aStage  The stage.
+ *
+ * @returns The name of @p aStage.
+ *
+ */
+const char *otrProfileStageName(otrProfileStage aStage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OT_FREERTOS_PROFILE_H_
@@ -0,0 +1,137 @@
+/*
+ *  Copyright (c) 2020, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "otr_state.h"
+
+#include <string.h>
+
+#include <openthread/link.h>
+
+#include "otr_boot.h"
+
+/**
+ * This structure publishes the state of one instance as a double buffer.
+ *
+ * The OpenThread task fills the buffer readers are not pointed at, then publishes it by bumping `mVersion`. A reader
+ * copies the published buffer and retries if the version moved meanwhile. Readers never wait for the writer, so a
+ * reader with a higher priority than the OpenThread task cannot starve it.
+ *
+ */
+typedef struct StatePublisher
+{
+    otInstance *     mInstance;
+    otrStateSnapshot mBuffers[2];
+    uint32_t         mVersion; ///< Published buffer is `mBuffers[mVersion & 1]`.
+} StatePublisher;
+
+static StatePublisher sPublisher;
+static otInstance *   sPublishedInstance; ///< Set once `sPublisher` holds a first snapshot.
+
+static void publishState(StatePublisher *aPublisher)
+{
+    otInstance *          instance = aPublisher->mInstance;
+    uint32_t              version  = aPublisher->mVersion + 1;
+    otrStateSnapshot *    snapshot = &aPublisher->mBuffers[version & 1];
+    const otNetifAddress *address;
+
+    // Keep the previous publication ordered before the writes below, readers of it may be copying this buffer.
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    snapshot->mVersion         = version;
+    snapshot->mRole            = otThreadGetDeviceRole(instance);
+    snapshot->mIp6Enabled      = otIp6IsEnabled(instance);
+    snapshot->mLinkEnabled     = otLinkIsEnabled(instance);
+    snapshot->mRloc16          = otThreadGetRloc16(instance);
+    snapshot->mPanId           = otLinkGetPanId(instance);
+    snapshot->mChannel         = otLinkGetChannel(instance);
+    snapshot->mPartitionId     = otThreadGetPartitionId(instance);
+    snapshot->mMeshLocalPrefix = *otThreadGetMeshLocalPrefix(instance);
+    snapshot->mMeshLocalEid    = *otThreadGetMeshLocalEid(instance);
+    snapshot->mNumAddresses    = 0;
+
+    for (address = otIp6GetUnicastAddresses(instance);
+         address != NULL && snapshot->mNumAddresses < OTR_CONFIG_STATE_MAX_ADDRESSES; address = address->mNext)
+    {
+        snapshot->mAddresses[snapshot->mNumAddresses++] = address->mAddress;
+    }
+
+    __atomic_store_n(&aPublisher->mVersion, version, __ATOMIC_RELEASE);
+}
+
+static void handleStateChanged(otChangedFlags aFlags, void *aContext)
+{
+    StatePublisher *publisher = (StatePublisher *)aContext;
+
+    publishState(publisher);
+
+    if ((aFlags & OT_CHANGED_THREAD_ROLE) && otThreadGetDeviceRole(publisher->mInstance) >= OT_DEVICE_ROLE_CHILD)
+    {
+        otrBootMark(OTR_BOOT_PHASE_ATTACHED);
+    }
+}
+
+otError otrStateInit(otInstance *aInstance)
+{
+    otError error = OT_ERROR_NO_BUFS;
+
+    if (sPublishedInstance == NULL)
+    {
+        sPublisher.mInstance = aInstance;
+        sPublisher.mVersion  = 0;
+
+        error = otSetStateChangedCallback(aInstance, handleStateChanged, &sPublisher);
+
+        if (error == OT_ERROR_NONE)
+        {
+            publishState(&sPublisher);
+            __atomic_store_n(&sPublishedInstance, aInstance, __ATOMIC_RELEASE);
+        }
+    }
+
+    return error;
+}
+
+otError otrStateGet(otInstance *aInstance, otrStateSnapshot *aSnapshot)
+{
+    otError  error = OT_ERROR_INVALID_ARGS;
+    uint32_t version;
+
+    if (aInstance != NULL && __atomic_load_n(&sPublishedInstance, __ATOMIC_ACQUIRE) == aInstance)
+    {
+        do
+        {
+            version = __atomic_load_n(&sPublisher.mVersion, __ATOMIC_ACQUIRE);
+            memcpy(aSnapshot, &sPublisher.mBuffers[version & 1], sizeof(*aSnapshot));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        } while (__atomic_load_n(&sPublisher.mVersion, __ATOMIC_RELAXED) != version);
+
+        error = OT_ERROR_NONE;
+    }
+
+    return error;
+}
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2020, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions of the OpenThread state snapshot, readable from any task without locking.
+ *
+ */
+
+#ifndef OT_FREERTOS_STATE_H_
+#define OT_FREERTOS_STATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <openthread/error.h>
+#include <openthread/instance.h>
+#include <openthread/ip6.h>
+#include <openthread/thread.h>
+
+#include "otr_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * This structure represents the commonly read state of an OpenThread instance.
+ *
+ */
+typedef struct otrStateSnapshot
+{
+    uint32_t          mVersion;      ///< Incremented on every update.
+    otDeviceRole      mRole;         ///< The Thread device role.
+    bool              mIp6Enabled;   ///< Whether the IPv6 interface is up.
+    bool              mLinkEnabled;  ///< Whether the link is enabled.
+    uint16_t          mRloc16;       ///< The RLOC16.
+    otPanId           mPanId;        ///< The PAN ID.
+    uint8_t           mChannel;      ///< The radio channel.
+    uint32_t          mPartitionId;  ///< The Thread partition ID.
+    otMeshLocalPrefix mMeshLocalPrefix;
+    otIp6Address      mMeshLocalEid;
+    otIp6Address      mAddresses[OTR_CONFIG_STATE_MAX_ADDRESSES]; ///< The first unicast addresses.
+    uint8_t           mNumAddresses;
+} otrStateSnapshot;
+
+/**
+ * This function starts publishing the state of an OpenThread instance.
+ *
+ * Must be called from the OpenThread task, or before the scheduler starts.
+ *
+ * @param[in]  aInstance  A pointer to the OpenThread instance.
+ *
+ * @retval OT_ERROR_NONE     Successfully started.
+ * @retval OT_ERROR_NO_BUFS  An instance is already published, or no state-changed callback slot is left.
+ *
+ */
+otError otrStateInit(otInstance *aInstance);
+
+/**
+ * This function gets the latest state snapshot of an OpenThread instance.
+ *
+ * It does not lock or wake the OpenThread task, and can be called from any task.
+ *
+ * @param[in]   aInstance  A pointer to the OpenThread instance.
+ * @param[out]  aSnapshot  A pointer to where the snapshot is copied.
+ *
+ * @retval OT_ERROR_NONE          Successfully copied the snapshot.
+ * @retval OT_ERROR_INVALID_ARGS  The state of @p aInstance is not published.
+ *
+ */
+otError otrStateGet(otInstance *aInstance, otrStateSnapshot *aSnapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OT_FREERTOS_STATE_H_
@@ -28,54 +28,606 @@
 
 #include "otr_system.h"
 
-#if PLATFORM_linux
+#include "otr_config.h"
+
+#include <arch/sys_arch.h>
+
+#if OTR_CONFIG_VIRTUAL_TIME && !PLATFORM_linux
+#error "OTR_CONFIG_VIRTUAL_TIME is only supported on Linux"
+#endif
+
+/**
+ * The task notification bits consumed by the OpenThread task.
+ *
+ * The bit of the lwIP thread semaphore is left pending, so a signal that arrives between two netconn waits of the
+ * OpenThread task is not lost.
+ *
+ */
+#define OTR_SYSTEM_NOTIFY_MASK (~(uint32_t)SYS_THREAD_SEM_NOTIFY_VALUE)
+
+#if PLATFORM_linux && !OTR_CONFIG_VIRTUAL_TIME
 
 #include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 
+#if OTR_CONFIG_LINUX_EPOLL
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#endif
+
+#include <FreeRTOS.h>
+#include <task.h>
+
 #include <platform-posix.h>
 #include <openthread/tasklet.h>
 
+#include "openthread/openthread-freertos.h"
+
 static struct otrSystemCtx
 {
     fd_set read_fds;
     fd_set write_fds;
     fd_set error_fds;
+    int    wakeup_fds[2]; ///< Pipe written by other tasks to break the OpenThread task out of its wait.
+#if OTR_CONFIG_LINUX_EPOLL
+    fd_set ready_read_fds;  ///< The descriptors handed to the drivers as readable.
+    fd_set ready_write_fds; ///< The descriptors handed to the drivers as writable.
+    int    epoll_fd;
+    int    num_registered;
+    struct
+    {
+        int      fd;
+        uint32_t events;     ///< The epoll events last armed for the descriptor.
+        uint32_t ready;      ///< Edges reported by epoll and not consumed yet.
+        uint32_t dispatched; ///< The events handed to the drivers in the current pass.
+    } registered[OTR_CONFIG_LINUX_EPOLL_MAX_FDS];
+#endif
 } sCtx;
 
-void otrSystemPoll(otInstance *aInstance)
+void otrSystemInit(void)
+{
+    if (pipe(sCtx.wakeup_fds) != 0 || fcntl(sCtx.wakeup_fds[0], F_SETFL, O_NONBLOCK) != 0 ||
+        fcntl(sCtx.wakeup_fds[1], F_SETFL, O_NONBLOCK) != 0)
+    {
+        perror("wakeup pipe");
+        exit(EXIT_FAILURE);
+    }
+
+#if OTR_CONFIG_LINUX_EPOLL
+    sCtx.epoll_fd       = epoll_create1(EPOLL_CLOEXEC);
+    sCtx.num_registered = 0;
+
+    if (sCtx.epoll_fd < 0)
+    {
+        perror("epoll_create1");
+        exit(EXIT_FAILURE);
+    }
+#endif
+}
+
+#if OTR_CONFIG_LINUX_EPOLL
+static void epollControl(int aOp, int aFd, uint32_t aEvents)
+{
+    struct epoll_event event;
+
+    event.events  = aEvents | EPOLLET;
+    event.data.fd = aFd;
+
+    // A descriptor closed by its driver has already left the epoll set.
+    if (epoll_ctl(sCtx.epoll_fd, aOp, aFd, &event) != 0 && !(aOp == EPOLL_CTL_DEL && errno == EBADF))
+    {
+        perror("epoll_ctl");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * This function returns the epoll events the drivers asked for on a descriptor, and clears it from the fd sets.
+ *
+ * Clearing as the registrations are walked leaves the fd sets empty for the next pass, without `FD_ZERO`.
+ *
+ */
+static uint32_t takeWantedEvents(int aFd)
+{
+    uint32_t wanted = 0;
+
+    if (FD_ISSET(aFd, &sCtx.read_fds))
+    {
+        wanted |= EPOLLIN;
+        FD_CLR(aFd, &sCtx.read_fds);
+    }
+
+    if (FD_ISSET(aFd, &sCtx.write_fds))
+    {
+        wanted |= EPOLLOUT;
+        FD_CLR(aFd, &sCtx.write_fds);
+    }
+
+    if (FD_ISSET(aFd, &sCtx.error_fds))
+    {
+        wanted |= EPOLLPRI;
+        FD_CLR(aFd, &sCtx.error_fds);
+    }
+
+    return wanted;
+}
+
+static fd_mask fdSetWord(const fd_set *aSet, int aWord)
+{
+    fd_mask word;
+
+    memcpy(&word, (const uint8_t *)aSet + aWord * sizeof(fd_mask), sizeof(word));
+
+    return word;
+}
+
+/**
+ * This function brings the epoll registrations in line with what the drivers asked for in this pass.
+ *
+ * Registrations persist across passes and are edge-triggered. Read and priority interest are registered once, so a
+ * pass only costs a system call when a descriptor appears or goes away, or when a driver starts waiting to write.
+ *
+ */
+static void updateRegistrations(int aMaxFd)
+{
+    int i = 0;
+
+    while (i < sCtx.num_registered)
+    {
+        int      fd     = sCtx.registered[i].fd;
+        uint32_t wanted = takeWantedEvents(fd);
+        uint32_t events = EPOLLIN | EPOLLPRI | (wanted & EPOLLOUT);
+
+        if (wanted == 0)
+        {
+            epollControl(EPOLL_CTL_DEL, fd, 0);
+            sCtx.registered[i] = sCtx.registered[--sCtx.num_registered];
+            continue;
+        }
+
+        // Modifying the registration makes epoll report the descriptor again if it is writable already.
+        if (events != sCtx.registered[i].events)
+        {
+            epollControl(EPOLL_CTL_MOD, fd, events);
+            sCtx.registered[i].events = events;
+        }
+
+        sCtx.registered[i].dispatched = wanted;
+        i++;
+    }
+
+    // What is left in the fd sets was not registered yet, look at whole words rather than one descriptor at a time.
+    for (int word = 0; word <= aMaxFd / NFDBITS; word++)
+    {
+        fd_mask bits = fdSetWord(&sCtx.read_fds, word) | fdSetWord(&sCtx.write_fds, word) |
+                       fdSetWord(&sCtx.error_fds, word);
+
+        while (bits != 0)
+        {
+            int      fd     = word * NFDBITS + __builtin_ctzl((unsigned long)bits);
+            uint32_t wanted = takeWantedEvents(fd);
+            uint32_t events = EPOLLIN | EPOLLPRI | (wanted & EPOLLOUT);
+
+            bits &= bits - 1;
+
+            if (sCtx.num_registered == OTR_CONFIG_LINUX_EPOLL_MAX_FDS)
+            {
+                fprintf(stderr, "epoll: more than %d descriptors\n", OTR_CONFIG_LINUX_EPOLL_MAX_FDS);
+                exit(EXIT_FAILURE);
+            }
+
+            epollControl(EPOLL_CTL_ADD, fd, events);
+            sCtx.registered[sCtx.num_registered].fd         = fd;
+            sCtx.registered[sCtx.num_registered].events     = events;
+            sCtx.registered[sCtx.num_registered].ready      = 0;
+            sCtx.registered[sCtx.num_registered].dispatched = wanted;
+            sCtx.num_registered++;
+        }
+    }
+}
+
+/**
+ * This function drops the edges the drivers consumed in the previous pass.
+ *
+ * Edge-triggered epoll only reports a descriptor again once more data arrives, while the POSIX drivers handle one
+ * message per pass. A readable descriptor therefore stays ready as long as it still has data queued. A writable one is
+ * handed to the drivers once, and its registration is modified again if a driver still waits to write.
+ *
+ */
+static void consumeReady(void)
+{
+    for (int i = 0; i < sCtx.num_registered; i++)
+    {
+        uint32_t consumed = sCtx.registered[i].ready & sCtx.registered[i].dispatched;
+        int      pending  = 0;
+
+        if ((consumed & EPOLLIN) &&
+            (ioctl(sCtx.registered[i].fd, FIONREAD, &pending) != 0 || pending == 0))
+        {
+            sCtx.registered[i].ready &= ~(uint32_t)EPOLLIN;
+        }
+
+        if (consumed & EPOLLOUT)
+        {
+            sCtx.registered[i].ready &= ~(uint32_t)EPOLLOUT;
+            sCtx.registered[i].events &= ~(uint32_t)EPOLLOUT;
+        }
+
+        sCtx.registered[i].ready &= ~(consumed & EPOLLPRI);
+    }
+}
+
+/**
+ * This function waits with epoll and hands the ready descriptors to the drivers.
+ *
+ * Only the descriptors that epoll reported are set in, or cleared from, the fd sets the drivers read.
+ *
+ * @returns The number of descriptors handed to the drivers, or -1 on error.
+ *
+ */
+static int waitEvents(int aMaxFd, struct timeval *aTimeout)
+{
+    struct epoll_event events[OTR_CONFIG_LINUX_EPOLL_EVENTS];
+    int                timeout = (int)(aTimeout->tv_sec * 1000 + (aTimeout->tv_usec + 999) / 1000);
+    int                ready   = 0;
+    int                rval;
+
+    consumeReady();
+    updateRegistrations(aMaxFd);
+
+    for (int i = 0; i < sCtx.num_registered; i++)
+    {
+        if (sCtx.registered[i].ready & sCtx.registered[i].dispatched)
+        {
+            // Data from an earlier edge is still waiting, only collect new edges.
+            timeout = 0;
+        }
+    }
+
+    rval = epoll_wait(sCtx.epoll_fd, events, OTR_CONFIG_LINUX_EPOLL_EVENTS, timeout);
+
+    for (int i = 0; i < rval; i++)
+    {
+        uint32_t edges = events[i].events;
+
+        // Errors and hangups are reported the way select does, as readiness for the next read or write.
+        if (edges & (EPOLLERR | EPOLLHUP))
+        {
+            edges |= EPOLLIN | EPOLLOUT;
+        }
+
+        for (int j = 0; j < sCtx.num_registered; j++)
+        {
+            if (sCtx.registered[j].fd == events[i].data.fd)
+            {
+                sCtx.registered[j].ready |= edges & (EPOLLIN | EPOLLOUT | EPOLLPRI);
+                break;
+            }
+        }
+    }
+
+    for (int i = 0; i < sCtx.num_registered; i++)
+    {
+        int fd = sCtx.registered[i].fd;
+
+        sCtx.registered[i].dispatched &= sCtx.registered[i].ready;
+
+        if (sCtx.registered[i].dispatched & EPOLLIN)
+        {
+            FD_SET(fd, &sCtx.ready_read_fds);
+        }
+        else
+        {
+            FD_CLR(fd, &sCtx.ready_read_fds);
+        }
+
+        if (sCtx.registered[i].dispatched & EPOLLOUT)
+        {
+            FD_SET(fd, &sCtx.ready_write_fds);
+        }
+        else
+        {
+            FD_CLR(fd, &sCtx.ready_write_fds);
+        }
+
+        ready += (sCtx.registered[i].dispatched != 0) ? 1 : 0;
+    }
+
+    return (rval < 0) ? rval : ready;
+}
+
+#define READY_READ_FDS (&sCtx.ready_read_fds)
+#define READY_WRITE_FDS (&sCtx.ready_write_fds)
+#else
+static int waitEvents(int aMaxFd, struct timeval *aTimeout)
+{
+    if (aMaxFd >= FD_SETSIZE)
+    {
+        fprintf(stderr, "descriptor %d is beyond FD_SETSIZE\n", aMaxFd);
+        exit(EXIT_FAILURE);
+    }
+
+    return select(aMaxFd + 1, &sCtx.read_fds, &sCtx.write_fds, &sCtx.error_fds, aTimeout);
+}
+
+#define READY_READ_FDS (&sCtx.read_fds)
+#define READY_WRITE_FDS (&sCtx.write_fds)
+#endif
+
+void otrSystemWakeup(void)
+{
+    const uint8_t wakeup = 0;
+    ssize_t       rval   = write(sCtx.wakeup_fds[1], &wakeup, sizeof(wakeup));
+
+    // A full pipe already guarantees a wakeup.
+    (void)rval;
+}
+
+uint32_t otrSystemPoll(bool aWorkPending)
 {
     int            max_fd = -1;
     struct timeval timeout;
     int            rval;
+    uint32_t       events   = 0;
+    uint32_t       notified = 0;
 
+#if !OTR_CONFIG_LINUX_EPOLL
+    // select overwrites the sets with the ready descriptors, the epoll backend leaves them empty after each pass.
     FD_ZERO(&sCtx.read_fds);
     FD_ZERO(&sCtx.write_fds);
     FD_ZERO(&sCtx.error_fds);
+#endif
 
     platformUartUpdateFdSet(&sCtx.read_fds, &sCtx.write_fds, &sCtx.error_fds, &max_fd);
     platformRadioUpdateFdSet(&sCtx.read_fds, &sCtx.write_fds, &max_fd);
     platformAlarmUpdateTimeout(&timeout);
 
-    if (!otTaskletsArePending(aInstance))
+    FD_SET(sCtx.wakeup_fds[0], &sCtx.read_fds);
+    if (max_fd < sCtx.wakeup_fds[0])
     {
-        rval = select(max_fd + 1, &sCtx.read_fds, &sCtx.write_fds, &sCtx.error_fds, &timeout);
+        max_fd = sCtx.wakeup_fds[0];
+    }
+
+    if (aWorkPending)
+    {
+        // Still collect the drivers that are ready, but do not wait for them.
+        timeout.tv_sec  = 0;
+        timeout.tv_usec = 0;
+    }
 
-        if ((rval < 0) && (errno != EINTR))
+    rval = waitEvents(max_fd, &timeout);
+
+    if (rval < 0)
+    {
+        if (errno != EINTR)
         {
-            perror("select");
+            perror(OTR_CONFIG_LINUX_EPOLL ? "epoll_wait" : "select");
             exit(EXIT_FAILURE);
         }
+
+        FD_ZERO(READY_READ_FDS);
+        FD_ZERO(READY_WRITE_FDS);
+        rval = 0;
     }
+
+    if (FD_ISSET(sCtx.wakeup_fds[0], READY_READ_FDS))
+    {
+        uint8_t buffer[16];
+
+        while (read(sCtx.wakeup_fds[0], buffer, sizeof(buffer)) > 0)
+        {
+        }
+
+        rval--;
+    }
+
+    // Any other descriptor is a driver, and a timeout (or a signal) may mean an alarm is due.
+    if (rval != 0 || !FD_ISSET(sCtx.wakeup_fds[0], READY_READ_FDS))
+    {
+        events |= OTR_EVENT_BIT(OTR_EVENT_DRIVER);
+    }
+
+    if (xTaskNotifyWait(0, OTR_SYSTEM_NOTIFY_MASK, &notified, 0) == pdTRUE)
+    {
+        events |= notified & OTR_SYSTEM_NOTIFY_MASK;
+    }
+
+    return events;
 }
 
 void otrSystemProcess(otInstance *aInstance)
 {
     platformUartProcess();
-    platformRadioProcess(aInstance, &sCtx.read_fds, &sCtx.write_fds);
+    platformRadioProcess(aInstance, READY_READ_FDS, READY_WRITE_FDS);
     platformAlarmProcess(aInstance);
 }
 
+#elif OTR_CONFIG_VIRTUAL_TIME
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <openthread-system.h>
+#include <openthread/platform/alarm-milli.h>
+
+#include "openthread/openthread-freertos.h"
+
+TickType_t otrTaskGetTicksToNextUnblock(void);
+
+void __real_otPlatAlarmMilliStartAt(otInstance *aInstance, uint32_t aT0, uint32_t aDt);
+void __real_otPlatAlarmMilliStop(otInstance *aInstance);
+
+static volatile bool sAdvancePending = false;
+static bool          sClockStarted   = false;
+static uint32_t      sClockNow; ///< OpenThread time in milliseconds, as last passed on to the FreeRTOS tick.
+static bool          sAlarmRunning = false; ///< Whether OpenThread itself has the millisecond alarm armed.
+static uint32_t      sAlarmT0;
+static uint32_t      sAlarmDt;
+
+/*
+ * The executable is linked with `--wrap` for these two, so that the alarm OpenThread asks for is known and can be put
+ * back after the simulator step was capped at a FreeRTOS timeout.
+ */
+void __wrap_otPlatAlarmMilliStartAt(otInstance *aInstance, uint32_t aT0, uint32_t aDt)
+{
+    sAlarmRunning = true;
+    sAlarmT0      = aT0;
+    sAlarmDt      = aDt;
+    __real_otPlatAlarmMilliStartAt(aInstance, aT0, aDt);
+}
+
+void __wrap_otPlatAlarmMilliStop(otInstance *aInstance)
+{
+    sAlarmRunning = false;
+    __real_otPlatAlarmMilliStop(aInstance);
+}
+
+/**
+ * This function stops the real time tick of the FreeRTOS Linux port, which runs from `ITIMER_REAL`, and makes the
+ * tick count follow the OpenThread alarm from now on.
+ *
+ */
+static void clockStart(void)
+{
+    const struct itimerval stop = {{0, 0}, {0, 0}};
+
+    if (setitimer(ITIMER_REAL, &stop, NULL) != 0)
+    {
+        perror("setitimer");
+        exit(EXIT_FAILURE);
+    }
+
+    sClockNow     = otPlatAlarmMilliGetNow();
+    sClockStarted = true;
+}
+
+/**
+ * This function steps the FreeRTOS tick to the OpenThread time.
+ *
+ * Tasks whose timeouts fall inside one step are unblocked in order, once the step is over.
+ *
+ */
+static void clockAdvance(void)
+{
+    TickType_t ticks = pdMS_TO_TICKS(otPlatAlarmMilliGetNow() - sClockNow);
+
+    if (ticks > 0)
+    {
+        sClockNow += ticks * portTICK_PERIOD_MS;
+        xTaskCatchUpTicks(ticks);
+    }
+}
+
+/**
+ * This function arms the platform alarm at the earliest FreeRTOS timeout when that comes before the OpenThread alarm,
+ * so that the simulator does not step past it.
+ *
+ * @param[in]  aInstance  The OpenThread instance.
+ *
+ * @returns Whether the platform alarm was replaced.
+ *
+ */
+static bool clockCapStep(otInstance *aInstance)
+{
+    TickType_t ticks  = otrTaskGetTicksToNextUnblock();
+    bool       capped = false;
+
+    if (ticks != portMAX_DELAY)
+    {
+        uint32_t dt = ticks * portTICK_PERIOD_MS;
+
+        if (!sAlarmRunning || (int32_t)((sAlarmT0 + sAlarmDt) - (sClockNow + dt)) > 0)
+        {
+            // Firing early is harmless, the OpenThread timer scheduler arms the alarm again for its own next timer.
+            __real_otPlatAlarmMilliStartAt(aInstance, sClockNow, dt);
+            capped = true;
+        }
+    }
+
+    return capped;
+}
+
+/**
+ * This function puts back the alarm OpenThread asked for after a capped step.
+ *
+ * @param[in]  aInstance  The OpenThread instance.
+ *
+ */
+static void clockRestoreAlarm(otInstance *aInstance)
+{
+    if (sAlarmRunning)
+    {
+        __real_otPlatAlarmMilliStartAt(aInstance, sAlarmT0, sAlarmDt);
+    }
+    else
+    {
+        __real_otPlatAlarmMilliStop(aInstance);
+    }
+}
+
+void vApplicationIdleHook(void)
+{
+    // Every task is blocked, let the simulator move time to the next event.
+    if (!sAdvancePending)
+    {
+        sAdvancePending = true;
+        otrEventSignal(OTR_EVENT_DRIVER);
+    }
+}
+
+void otrSystemInit(void)
+{
+}
+
+void otrSystemWakeup(void)
+{
+}
+
+uint32_t otrSystemPoll(bool aWorkPending)
+{
+    uint32_t events = 0;
+
+    if (xTaskNotifyWait(0, OTR_SYSTEM_NOTIFY_MASK, &events, aWorkPending ? 0 : portMAX_DELAY) != pdTRUE)
+    {
+        events = 0;
+    }
+
+    return events & OTR_SYSTEM_NOTIFY_MASK;
+}
+
+void otrSystemProcess(otInstance *aInstance)
+{
+    if (!sClockStarted)
+    {
+        // The port arms its tick timer when the scheduler starts, which is before the OpenThread task first runs.
+        clockStart();
+    }
+
+    if (sAdvancePending)
+    {
+        bool capped = clockCapStep(aInstance);
+
+        // Sleeps in the simulator until the next alarm or radio event, then processes the drivers.
+        otSysProcessDrivers(aInstance);
+
+        if (capped)
+        {
+            clockRestoreAlarm(aInstance);
+        }
+
+        clockAdvance();
+        sAdvancePending = false;
+    }
+}
+
 #else
 
 #include <FreeRTOS.h>
@@ -84,12 +636,24 @@ void otrSystemProcess(otInstance *aInstance)
 #include <openthread-system.h>
 #include <openthread/tasklet.h>
 
-void otrSystemPoll(otInstance *aInstance)
+void otrSystemInit(void)
 {
-    if (!otTaskletsArePending(aInstance))
+}
+
+void otrSystemWakeup(void)
+{
+}
+
+uint32_t otrSystemPoll(bool aWorkPending)
+{
+    uint32_t events = 0;
+
+    if (xTaskNotifyWait(0, OTR_SYSTEM_NOTIFY_MASK, &events, aWorkPending ? 0 : portMAX_DELAY) != pdTRUE)
     {
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        events = 0;
     }
+
+    return events & OTR_SYSTEM_NOTIFY_MASK;
 }
 
 void otrSystemProcess(otInstance *aInstance)
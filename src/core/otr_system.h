@@ -33,20 +33,37 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include <openthread/instance.h>
 
+/**
+ * This function initializes the system event sources.
+ *
+ */
+void otrSystemInit(void);
+
+/**
+ * This function wakes up `otrSystemPoll`, on platforms where it does not wait on the task notification.
+ *
+ */
+void otrSystemWakeup(void);
+
 /**
  * This function waits for a system event
  *
- *  @param[in] aInstance  OpenThread instance
+ *  @param[in] aWorkPending  Whether the OpenThread task has work left, in which case it does not wait
+ *
+ *  @returns The `OTR_EVENT_BIT` mask of the events signalled to the OpenThread task.
  *
  */
-void otrSystemPoll(otInstance *aInstance);
+uint32_t otrSystemPoll(bool aWorkPending);
 
 /**
  * This function performs system level process
  *
- *  @param[in] aInstance  OpenThread instance
+ *  @param[in] aInstance  OpenThread instance that receives the driver events
  *
  */
 void otrSystemProcess(otInstance *aInstance);
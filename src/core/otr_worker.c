@@ -0,0 +1,136 @@
+/*
+ *  Copyright (c) 2020, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "otr_worker.h"
+
+#include <assert.h>
+
+#include <queue.h>
+
+#include "otr_config.h"
+#include "utils/static_alloc.h"
+
+static QueueHandle_t sJobQueue   = NULL;
+static UBaseType_t   sFreeWorkers = 0; ///< Worker tasks not running or promised a job, guarded by a critical section.
+
+#if OTR_CONFIG_STATIC_ALLOCATION
+static otrWorkerJob * sJobQueueStorage[OTR_CONFIG_WORKER_POOL_SIZE] OTR_STATIC_RESERVED;
+static StaticQueue_t  sJobQueueBuffer OTR_STATIC_RESERVED;
+static StackType_t    sWorkerStacks[OTR_CONFIG_WORKER_POOL_SIZE][OTR_CONFIG_WORKER_STACK_SIZE] OTR_STATIC_RESERVED;
+static StaticTask_t   sWorkerBuffers[OTR_CONFIG_WORKER_POOL_SIZE] OTR_STATIC_RESERVED;
+#endif
+
+static void workerTask(void *aContext)
+{
+    otrWorkerJob *job;
+
+    (void)aContext;
+
+    while (true)
+    {
+        if (xQueueReceive(sJobQueue, &job, portMAX_DELAY) == pdTRUE)
+        {
+            job->mHandler(job->mContext);
+
+            // Released together, so a resubmit that sees the job idle also finds this worker free.
+            taskENTER_CRITICAL();
+            job->mBusy = false;
+            sFreeWorkers++;
+            taskEXIT_CRITICAL();
+        }
+    }
+}
+
+void otrWorkerInit(void)
+{
+    assert(sJobQueue == NULL);
+
+    sFreeWorkers = OTR_CONFIG_WORKER_POOL_SIZE;
+
+#if OTR_CONFIG_STATIC_ALLOCATION
+    sJobQueue = xQueueCreateStatic(OTR_CONFIG_WORKER_POOL_SIZE, sizeof(otrWorkerJob *), (uint8_t *)sJobQueueStorage,
+                                   &sJobQueueBuffer);
+
+    for (uint8_t i = 0; i < OTR_CONFIG_WORKER_POOL_SIZE; i++)
+    {
+        xTaskCreateStatic(workerTask, "worker", OTR_CONFIG_WORKER_STACK_SIZE, NULL, OTR_CONFIG_WORKER_PRIORITY,
+                          sWorkerStacks[i], &sWorkerBuffers[i]);
+    }
+#else
+    sJobQueue = xQueueCreate(OTR_CONFIG_WORKER_POOL_SIZE, sizeof(otrWorkerJob *));
+    assert(sJobQueue != NULL);
+
+    for (uint8_t i = 0; i < OTR_CONFIG_WORKER_POOL_SIZE; i++)
+    {
+        BaseType_t rval = xTaskCreate(workerTask, "worker", OTR_CONFIG_WORKER_STACK_SIZE, NULL,
+                                      OTR_CONFIG_WORKER_PRIORITY, NULL);
+
+        assert(rval == pdPASS);
+        (void)rval;
+    }
+#endif
+}
+
+otError otrWorkerSubmit(otrWorkerJob *aJob)
+{
+    otError error = OT_ERROR_NONE;
+
+    taskENTER_CRITICAL();
+
+    if (aJob->mBusy)
+    {
+        error = OT_ERROR_BUSY;
+    }
+    else if (sFreeWorkers == 0)
+    {
+        error = OT_ERROR_NO_BUFS;
+    }
+    else
+    {
+        aJob->mBusy = true;
+        sFreeWorkers--;
+    }
+
+    taskEXIT_CRITICAL();
+
+    if (error == OT_ERROR_NONE)
+    {
+        // The queue holds one entry per worker, so it has room for every job that was promised one.
+        BaseType_t rval = xQueueSend(sJobQueue, &aJob, 0);
+
+        assert(rval == pdTRUE);
+        (void)rval;
+    }
+
+    return error;
+}
+
+bool otrWorkerIsBusy(const otrWorkerJob *aJob)
+{
+    return aJob->mBusy;
+}
@@ -0,0 +1,107 @@
+/*
+ *  Copyright (c) 2020, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions of the worker task pool, which runs application jobs on preallocated tasks.
+ *
+ */
+
+#ifndef OT_FREERTOS_WORKER_H_
+#define OT_FREERTOS_WORKER_H_
+
+#include <stdbool.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <openthread/error.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * This function pointer is called by a worker task to run a job.
+ *
+ * @param[in]  aContext  The context of the job.
+ *
+ */
+typedef void (*otrWorkerHandler)(void *aContext);
+
+/**
+ * This structure represents a job run by the worker pool.
+ *
+ * A job must stay valid until it is no longer busy, and can be submitted again from then on.
+ *
+ */
+typedef struct otrWorkerJob
+{
+    otrWorkerHandler mHandler; ///< The function to run in a worker task.
+    void *           mContext; ///< The argument passed to @p mHandler.
+    volatile bool    mBusy;    ///< Set while the job is queued or running.
+} otrWorkerJob;
+
+/**
+ * This function creates the worker tasks and the job queue.
+ *
+ * It must be called once, before any job is submitted.
+ *
+ */
+void otrWorkerInit(void);
+
+/**
+ * This function hands a job to a free worker task.
+ *
+ * A job is only accepted when a worker is free to run it, so that it never waits behind jobs that do not return.
+ * Work that runs for the lifetime of the application belongs in a task of its own.
+ *
+ * @param[in]  aJob  A pointer to the job, with @p mHandler and @p mContext filled in.
+ *
+ * @retval OT_ERROR_NONE     Successfully queued the job.
+ * @retval OT_ERROR_BUSY     The job is still queued or running.
+ * @retval OT_ERROR_NO_BUFS  Every worker task is taken.
+ *
+ */
+otError otrWorkerSubmit(otrWorkerJob *aJob);
+
+/**
+ * This function indicates whether a job is queued or running.
+ *
+ * @param[in]  aJob  A pointer to the job.
+ *
+ * @returns Whether @p aJob is busy.
+ *
+ */
+bool otrWorkerIsBusy(const otrWorkerJob *aJob);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OT_FREERTOS_WORKER_H_
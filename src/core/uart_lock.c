@@ -31,14 +31,25 @@
 #include <FreeRTOS.h>
 #include <semphr.h>
 
+#include "otr_config.h"
+#include "utils/static_alloc.h"
+
 /**
  * UART Lock
  */
 static xSemaphoreHandle sUartMtx;
 
+#if OTR_CONFIG_STATIC_ALLOCATION
+static StaticSemaphore_t sUartMtxBuffer OTR_STATIC_RESERVED;
+#endif
+
 otError otrUartLockInit(void)
 {
+#if OTR_CONFIG_STATIC_ALLOCATION
+    sUartMtx = xSemaphoreCreateMutexStatic(&sUartMtxBuffer);
+#else
     sUartMtx = xSemaphoreCreateMutex();
+#endif
     return OT_ERROR_NONE;
 }
 
@@ -0,0 +1,60 @@
+/*
+ *  Copyright (c) 2020, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "histogram.h"
+
+#include <string.h>
+
+void otrHistogramReset(otrHistogram *aHistogram)
+{
+    memset(aHistogram, 0, sizeof(*aHistogram));
+}
+
+void otrHistogramAdd(otrHistogram *aHistogram, uint32_t aValue)
+{
+    uint8_t bucket = (aValue == 0) ? 0 : (uint8_t)(32 - __builtin_clz(aValue));
+
+    if (bucket >= OTR_HISTOGRAM_NUM_BUCKETS)
+    {
+        bucket = OTR_HISTOGRAM_NUM_BUCKETS - 1;
+    }
+
+    aHistogram->mBuckets[bucket]++;
+    aHistogram->mCount++;
+    aHistogram->mSum += aValue;
+
+    if (aValue > aHistogram->mMax)
+    {
+        aHistogram->mMax = aValue;
+    }
+}
+
+uint32_t otrHistogramBucketLimit(uint8_t aBucket)
+{
+    return (aBucket + 1 >= OTR_HISTOGRAM_NUM_BUCKETS) ? UINT32_MAX : (uint32_t)((1ULL << aBucket) - 1);
+}
@@ -0,0 +1,90 @@
+/*
+ *  Copyright (c) 2020, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OTR_HISTOGRAM_H_
+#define OTR_HISTOGRAM_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The number of buckets in a histogram.
+ *
+ */
+#define OTR_HISTOGRAM_NUM_BUCKETS 20
+
+/**
+ * This structure represents a histogram with power-of-two buckets.
+ *
+ * Bucket 0 counts samples of 0, bucket i counts samples in [2^(i-1), 2^i) and the last bucket also counts everything
+ * larger.
+ *
+ */
+typedef struct otrHistogram
+{
+    uint32_t mBuckets[OTR_HISTOGRAM_NUM_BUCKETS];
+    uint32_t mCount; ///< Number of samples.
+    uint32_t mMax;   ///< Largest sample.
+    uint64_t mSum;   ///< Sum of all samples.
+} otrHistogram;
+
+/**
+ * This function clears all samples from a histogram.
+ *
+ * @param[in]  aHistogram  A pointer to the histogram.
+ *
+ */
+void otrHistogramReset(otrHistogram *aHistogram);
+
+/**
+ * This function records a sample in a histogram.
+ *
+ * @param[in]  aHistogram  A pointer to the histogram.
+ * @param[in]  aValue      The sample value.
+ *
+ */
+void otrHistogramAdd(otrHistogram *aHistogram, uint32_t aValue);
+
+/**
+ * This function returns the largest value counted by a bucket.
+ *
+ * @param[in]  aBucket  The bucket index.
+ *
+ * @returns The inclusive upper bound of @p aBucket, UINT32_MAX for the last bucket.
+ *
+ */
+uint32_t otrHistogramBucketLimit(uint8_t aBucket);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OTR_HISTOGRAM_H_
@@ -0,0 +1,253 @@
+/*
+ *  Copyright (c) 2020, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "lock_stats.h"
+
+#include <string.h>
+
+#include <task.h>
+
+#include "utils/time_utils.h"
+
+#if OTR_CONFIG_LOCK_STATS
+
+/**
+ * This structure records when a lock object was taken, a lock is only held by one task at a time.
+ *
+ */
+typedef struct HeldLock
+{
+    const void *mObject;
+    uint32_t    mStart;
+} HeldLock;
+
+static otrLockStats sStats;
+static HeldLock     sHeld[OTR_CONFIG_LOCK_STATS_MAX_HELD];
+
+static void updateCounters(otrLockStatsCounters *aCounters, uint32_t aWait, bool aContended)
+{
+    aCounters->mAcquired++;
+    aCounters->mContended += aContended ? 1 : 0;
+    aCounters->mWaitTotal += aWait;
+
+    if (aWait > aCounters->mWaitMax)
+    {
+        aCounters->mWaitMax = aWait;
+    }
+}
+
+static void updateHold(otrLockStatsCounters *aCounters, uint32_t aHold)
+{
+    aCounters->mHoldTotal += aHold;
+
+    if (aHold > aCounters->mHoldMax)
+    {
+        aCounters->mHoldMax = aHold;
+    }
+}
+
+static void resetTask(otrLockStatsTask *aEntry, void *aTask)
+{
+    memset(aEntry, 0, sizeof(*aEntry));
+    aEntry->mTask = aTask;
+    strncpy(aEntry->mName, pcTaskGetName(aTask), sizeof(aEntry->mName) - 1);
+}
+
+static otrLockStatsTask *findTask(void *aTask, bool aAdd)
+{
+    otrLockStatsTask *entry = NULL;
+
+    for (uint8_t i = 0; i < sStats.mNumTasks && entry == NULL; i++)
+    {
+        if (sStats.mTasks[i].mTask == aTask)
+        {
+            entry = &sStats.mTasks[i];
+        }
+    }
+
+    // The handle of a deleted task may be reused by a new one, which starts over when its name differs.
+    if (entry != NULL && strncmp(entry->mName, pcTaskGetName(aTask), sizeof(entry->mName) - 1) != 0)
+    {
+        if (aAdd)
+        {
+            resetTask(entry, aTask);
+        }
+        else
+        {
+            entry = NULL;
+        }
+    }
+
+    if (entry == NULL && aAdd && sStats.mNumTasks < OTR_CONFIG_LOCK_STATS_MAX_TASKS)
+    {
+        entry = &sStats.mTasks[sStats.mNumTasks++];
+        resetTask(entry, aTask);
+    }
+
+    return entry;
+}
+
+static void holdBegin(const void *aObject, uint32_t aNow)
+{
+    for (uint8_t i = 0; i < OTR_CONFIG_LOCK_STATS_MAX_HELD; i++)
+    {
+        if (sHeld[i].mObject == NULL)
+        {
+            sHeld[i].mObject = aObject;
+            sHeld[i].mStart  = aNow;
+            break;
+        }
+    }
+}
+
+static bool holdEnd(const void *aObject, uint32_t aNow, uint32_t *aHold)
+{
+    bool found = false;
+
+    for (uint8_t i = 0; i < OTR_CONFIG_LOCK_STATS_MAX_HELD && !found; i++)
+    {
+        if (sHeld[i].mObject == aObject)
+        {
+            *aHold           = aNow - sHeld[i].mStart;
+            sHeld[i].mObject = NULL;
+            found            = true;
+        }
+    }
+
+    return found;
+}
+
+static bool isTracking(void)
+{
+    // Locks are also taken before the scheduler runs, when there is no current task to account them to.
+    return xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+uint32_t otrLockStatsWaitBegin(void)
+{
+    return (uint32_t)otrTimeGetUs();
+}
+
+void otrLockStatsAcquired(otrLockStatsLock aLock, const void *aObject, uint32_t aWaitStart, bool aContended)
+{
+    uint32_t          now  = (uint32_t)otrTimeGetUs();
+    uint32_t          wait = now - aWaitStart;
+    otrLockStatsTask *task;
+
+    if (isTracking())
+    {
+        taskENTER_CRITICAL();
+
+        updateCounters(&sStats.mLocks[aLock], wait, aContended);
+
+        task = findTask(xTaskGetCurrentTaskHandle(), true);
+
+        if (task != NULL)
+        {
+            updateCounters(&task->mLocks[aLock], wait, aContended);
+        }
+        else
+        {
+            sStats.mUntracked++;
+        }
+
+        holdBegin(aObject, now);
+
+        taskEXIT_CRITICAL();
+    }
+}
+
+void otrLockStatsReleased(otrLockStatsLock aLock, const void *aObject)
+{
+    uint32_t          now = (uint32_t)otrTimeGetUs();
+    uint32_t          hold;
+    otrLockStatsTask *task;
+
+    if (isTracking())
+    {
+        taskENTER_CRITICAL();
+
+        // A reset between acquiring and releasing leaves no start to measure from.
+        if (holdEnd(aObject, now, &hold))
+        {
+            updateHold(&sStats.mLocks[aLock], hold);
+
+            task = findTask(xTaskGetCurrentTaskHandle(), false);
+
+            if (task != NULL)
+            {
+                updateHold(&task->mLocks[aLock], hold);
+            }
+        }
+
+        taskEXIT_CRITICAL();
+    }
+}
+
+bool otrLockStatsGet(otrLockStats *aStats)
+{
+    taskENTER_CRITICAL();
+    *aStats = sStats;
+    taskEXIT_CRITICAL();
+
+    return true;
+}
+
+void otrLockStatsReset(void)
+{
+    taskENTER_CRITICAL();
+    memset(&sStats, 0, sizeof(sStats));
+    memset(sHeld, 0, sizeof(sHeld));
+    taskEXIT_CRITICAL();
+}
+
+#else // OTR_CONFIG_LOCK_STATS
+
+bool otrLockStatsGet(otrLockStats *aStats)
+{
+    (void)aStats;
+
+    return false;
+}
+
+void otrLockStatsReset(void)
+{
+}
+
+#endif // OTR_CONFIG_LOCK_STATS
+
+const char *otrLockStatsLockName(otrLockStatsLock aLock)
+{
+    static const char *const kNames[OTR_LOCK_STATS_NUM_LOCKS] = {
+        "openthread",
+        "tcpip core",
+        "lwip other",
+    };
+
+    return (aLock < OTR_LOCK_STATS_NUM_LOCKS) ? kNames[aLock] : "unknown";
+}
@@ -0,0 +1,177 @@
+/*
+ *  Copyright (c) 2020, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OTR_LOCK_STATS_H_
+#define OTR_LOCK_STATS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <FreeRTOS.h>
+
+#include "otr_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * This enumeration defines the profiled locks.
+ *
+ */
+typedef enum otrLockStatsLock
+{
+    OTR_LOCK_STATS_OPENTHREAD, ///< The OpenThread API lock, `otrLock`.
+    OTR_LOCK_STATS_TCPIP_CORE, ///< The lwIP core lock, `LOCK_TCPIP_CORE`.
+    OTR_LOCK_STATS_LWIP_OTHER, ///< All other lwIP mutexes.
+    OTR_LOCK_STATS_NUM_LOCKS,
+} otrLockStatsLock;
+
+/**
+ * This structure represents the counters of one lock, times are in microseconds.
+ *
+ */
+typedef struct otrLockStatsCounters
+{
+    uint32_t mAcquired;  ///< Number of acquisitions.
+    uint32_t mContended; ///< Number of acquisitions that found the lock taken.
+    uint64_t mWaitTotal; ///< Total time spent waiting to acquire.
+    uint32_t mWaitMax;   ///< Longest wait.
+    uint64_t mHoldTotal; ///< Total time held.
+    uint32_t mHoldMax;   ///< Longest hold.
+} otrLockStatsCounters;
+
+/**
+ * This structure represents the counters of the locks taken by one task.
+ *
+ */
+typedef struct otrLockStatsTask
+{
+    void *               mTask;                            ///< The task handle.
+    char                 mName[configMAX_TASK_NAME_LEN];   ///< The task name when first seen.
+    otrLockStatsCounters mLocks[OTR_LOCK_STATS_NUM_LOCKS]; ///< Indexed by `otrLockStatsLock`.
+} otrLockStatsTask;
+
+/**
+ * This structure represents the lock contention profile.
+ *
+ */
+typedef struct otrLockStats
+{
+    otrLockStatsCounters mLocks[OTR_LOCK_STATS_NUM_LOCKS];        ///< All tasks, indexed by `otrLockStatsLock`.
+    otrLockStatsTask     mTasks[OTR_CONFIG_LOCK_STATS_MAX_TASKS]; ///< The tasks seen so far.
+    uint8_t              mNumTasks;                               ///< Number of entries in `mTasks`.
+    uint32_t             mUntracked;                              ///< Acquisitions by tasks that did not fit `mTasks`.
+} otrLockStats;
+
+#if OTR_CONFIG_LOCK_STATS
+
+/**
+ * This function returns the timestamp to pass to `otrLockStatsAcquired` once the lock is taken.
+ *
+ */
+uint32_t otrLockStatsWaitBegin(void);
+
+/**
+ * This function records an acquisition by the current task.
+ *
+ * @param[in]  aLock       The lock.
+ * @param[in]  aObject     The lock object, which tells apart locks of the same `otrLockStatsLock` held at once.
+ * @param[in]  aWaitStart  The timestamp returned by `otrLockStatsWaitBegin` before waiting.
+ * @param[in]  aContended  Whether the lock was taken when the task tried to acquire it.
+ *
+ */
+void otrLockStatsAcquired(otrLockStatsLock aLock, const void *aObject, uint32_t aWaitStart, bool aContended);
+
+/**
+ * This function records the current task releasing a lock.
+ *
+ * @param[in]  aLock    The lock.
+ * @param[in]  aObject  The lock object passed to `otrLockStatsAcquired`.
+ *
+ */
+void otrLockStatsReleased(otrLockStatsLock aLock, const void *aObject);
+
+#else
+
+static inline uint32_t otrLockStatsWaitBegin(void)
+{
+    return 0;
+}
+
+static inline void otrLockStatsAcquired(otrLockStatsLock aLock,
+                                        const void *     aObject,
+                                        uint32_t         aWaitStart,
+                                        bool             aContended)
+{
+    (void)aLock;
+    (void)aObject;
+    (void)aWaitStart;
+    (void)aContended;
+}
+
+static inline void otrLockStatsReleased(otrLockStatsLock aLock, const void *aObject)
+{
+    (void)aLock;
+    (void)aObject;
+}
+
+#endif // OTR_CONFIG_LOCK_STATS
+
+/**
+ * This function gets the lock contention profile.
+ *
+ * @param[out]  aStats  A pointer to where to copy the profile.
+ *
+ * @retval true   Successfully copied the profile.
+ * @retval false  `OTR_CONFIG_LOCK_STATS` is disabled.
+ *
+ */
+bool otrLockStatsGet(otrLockStats *aStats);
+
+/**
+ * This function clears the lock contention profile.
+ *
+ */
+void otrLockStatsReset(void);
+
+/**
+ * This function returns the name of a lock.
+ *
+ * @param[in]  aLock  The lock.
+ *
+ * @returns The name of @p aLock.
+ *
+ */
+const char *otrLockStatsLockName(otrLockStatsLock aLock);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OTR_LOCK_STATS_H_
@@ -0,0 +1,65 @@
+/*
+ *  Copyright (c) 2020, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OTR_TIME_UTILS_H_
+#define OTR_TIME_UTILS_H_
+
+#include <stdint.h>
+
+#include <FreeRTOS.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * This function returns the monotonic time in microseconds.
+ *
+ * The clock is the platform RTC on nRF52840, which keeps running while the CPU sleeps, and the monotonic clock on
+ * Linux, or the simulated clock with `OTR_CONFIG_VIRTUAL_TIME`. It does not wrap.
+ *
+ * @returns The time in microseconds since an arbitrary point before boot.
+ *
+ */
+uint64_t otrTimeGetUs(void);
+
+/**
+ * This function converts a timeout to FreeRTOS ticks.
+ *
+ * @param[in]  aMilliseconds  The timeout in milliseconds.
+ *
+ * @returns The timeout in ticks, rounded up so that a timeout shorter than a tick still blocks.
+ *
+ */
+TickType_t otrTimeMsToTicks(uint32_t aMilliseconds);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OTR_TIME_UTILS_H_
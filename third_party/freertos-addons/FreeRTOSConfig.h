@@ -86,7 +86,12 @@ extern "C" {
 
 #define configUSE_PREEMPTION 1
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#if OTR_CONFIG_VIRTUAL_TIME
+#define configUSE_IDLE_HOOK 1 /* Advances virtual time once every task is blocked. */
+#define configINCLUDE_FREERTOS_TASK_C_ADDITIONS_H 1 /* Tells the simulator when the next task times out. */
+#else
 #define configUSE_IDLE_HOOK 0
+#endif
 #define configUSE_TICK_HOOK 0
 #define configTICK_RATE_HZ (1000)
 #define configMINIMAL_STACK_SIZE                                                                                     \
@@ -106,9 +111,13 @@ extern "C" {
 #define configUSE_COUNTING_SEMAPHORES 1
 #define configUSE_QUEUE_SETS 1
 #define configUSE_TASK_NOTIFICATIONS 1
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS 1 /* lwIP thread semaphore */
 
 /* Software timer related configuration options. */
 #define configUSE_TIMERS 1
+#if OTR_CONFIG_STATIC_ALLOCATION
+#define configSUPPORT_STATIC_ALLOCATION 1
+#endif
 #define configTIMER_TASK_PRIORITY (configMAX_PRIORITIES - 1)
 #define configTIMER_QUEUE_LENGTH 20
 #define configTIMER_TASK_STACK_DEPTH (configMINIMAL_STACK_SIZE * 2)
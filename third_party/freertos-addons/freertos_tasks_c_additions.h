@@ -0,0 +1,61 @@
+/*
+ *  Copyright (c) 2020, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file is included at the end of tasks.c when `configINCLUDE_FREERTOS_TASK_C_ADDITIONS_H` is set, so that it
+ *   can read the scheduler state that tasks.c keeps private.
+ *
+ */
+
+#ifndef FREERTOS_TASKS_C_ADDITIONS_H_
+#define FREERTOS_TASKS_C_ADDITIONS_H_
+
+/**
+ * This function returns the number of ticks until the earliest blocked task times out.
+ *
+ * @returns The number of ticks, or `portMAX_DELAY` if no task is blocked with a timeout.
+ *
+ */
+TickType_t otrTaskGetTicksToNextUnblock(void)
+{
+    TickType_t ticks = portMAX_DELAY;
+
+    taskENTER_CRITICAL();
+
+    if (xNextTaskUnblockTime != portMAX_DELAY)
+    {
+        ticks = xNextTaskUnblockTime - xTickCount;
+    }
+
+    taskEXIT_CRITICAL();
+
+    return ticks;
+}
+
+#endif // FREERTOS_TASKS_C_ADDITIONS_H_
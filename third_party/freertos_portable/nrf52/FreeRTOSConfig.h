@@ -75,7 +75,11 @@
 #define configUSE_QUEUE_SETS                                                      0
 #define configUSE_TIME_SLICING                                                    0
 #define configUSE_NEWLIB_REENTRANT                                                0
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS                                   1    /* lwIP thread semaphore */
 #define configENABLE_BACKWARD_COMPATIBILITY                                       1
+#if OTR_CONFIG_STATIC_ALLOCATION
+#define configSUPPORT_STATIC_ALLOCATION                                           1
+#endif
 
 /* Hook function related definitions. */
 #define configUSE_IDLE_HOOK                                                       0
@@ -41,13 +41,7 @@ extern "C" {
 typedef xSemaphoreHandle sys_sem_t;
 typedef xSemaphoreHandle sys_mutex_t;
 typedef xTaskHandle      sys_thread_t;
-
-typedef struct sys_mbox_s
-{
-    xQueueHandle os_mbox;
-    sys_mutex_t  lock;
-    uint8_t      alive;
-} * sys_mbox_t;
+typedef xQueueHandle     sys_mbox_t;
 
 #define LWIP_COMPAT_MUTEX 0
 
@@ -64,6 +58,40 @@ typedef struct sys_mbox_s
 
 typedef uint32_t sys_prot_t;
 
+/**
+ * The task notification bit that signals the thread semaphore, next to `OTR_COMMAND_NOTIFY_VALUE`.
+ *
+ * It is reserved in every task that makes netconn or socket calls, the OpenThread task leaves it out of the bits it
+ * clears.
+ *
+ */
+#define SYS_THREAD_SEM_NOTIFY_VALUE (1UL << 29)
+
+/**
+ * The FreeRTOS thread local storage slot holding the thread semaphore.
+ *
+ */
+#define SYS_THREAD_SEM_TLS_INDEX 0
+
+/**
+ * This function returns the semaphore of the calling thread, creating it on first use.
+ *
+ * The semaphore is signalled through a task notification bit rather than a kernel object, and is only valid for
+ * `sys_sem_signal` and `sys_arch_sem_wait`.
+ *
+ */
+sys_sem_t *sys_thread_sem_get(void);
+
+/**
+ * This function frees the semaphore of the calling thread, if it has one.
+ *
+ */
+void sys_thread_sem_free(void);
+
+#define LWIP_NETCONN_THREAD_SEM_GET() sys_thread_sem_get()
+#define LWIP_NETCONN_THREAD_SEM_ALLOC() ((void)sys_thread_sem_get())
+#define LWIP_NETCONN_THREAD_SEM_FREE() sys_thread_sem_free()
+
 #ifdef __cplusplus
 }
 #endif
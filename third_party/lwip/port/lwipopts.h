@@ -376,6 +376,13 @@
  */
 #define LWIP_NETCONN 1
 
+/**
+ * LWIP_NETCONN_SEM_PER_THREAD==1: Use one (thread-local) semaphore per
+ * thread calling socket/netconn functions instead of allocating one
+ * semaphore per netconn (and per select etc.)
+ */
+#define LWIP_NETCONN_SEM_PER_THREAD 1
+
 /*
    ------------------------------------
    ---------- Socket options ----------
@@ -442,6 +449,11 @@
 
 #define LWIP_TCPIP_CORE_LOCKING 1
 
+/**
+ * LWIP_HOOK_FILENAME: Custom filename to #include in files that provide hooks.
+ */
+#define LWIP_HOOK_FILENAME "lwip_hooks.h"
+
 #define LWIP_ALTCP 1
 #define LWIP_ALTCP_TLS 1
 #define LWIP_ALTCP_TLS_MBEDTLS 1
@@ -41,17 +41,95 @@
 #include <lwip/mem.h>
 #include <lwip/stats.h>
 #include <lwip/sys.h>
+#include <lwip/tcpip.h>
 
 #include <stdbool.h>
 
-static sys_mutex_t g_lwip_protect_mutex = NULL;
+#include "otr_config.h"
+#include "utils/lock_stats.h"
+#include "utils/static_alloc.h"
+#include "utils/time_utils.h"
+
+#if OTR_CONFIG_STATIC_ALLOCATION
+/* Connection mailboxes share one capacity, the TCPIP thread mailbox has its own entry. */
+#define STATIC_MBOX_CAPACITY                                                 \
+    LWIP_MAX(LWIP_MAX(DEFAULT_TCP_RECVMBOX_SIZE, DEFAULT_UDP_RECVMBOX_SIZE), \
+             LWIP_MAX(DEFAULT_RAW_RECVMBOX_SIZE, DEFAULT_ACCEPTMBOX_SIZE))
+#define STATIC_MBOX_COUNT (OTR_CONFIG_STATIC_LWIP_MBOXES + 1)
+
+struct static_mbox
+{
+    StaticQueue_t queue; /* First, so that the queue handle points at its pool entry. */
+};
+
+static StaticSemaphore_t  g_static_mutexes[OTR_CONFIG_STATIC_LWIP_MUTEXES] OTR_STATIC_RESERVED;
+static bool               g_static_mutex_used[OTR_CONFIG_STATIC_LWIP_MUTEXES] OTR_STATIC_RESERVED;
+static StaticSemaphore_t  g_static_sems[OTR_CONFIG_STATIC_LWIP_SEMAPHORES] OTR_STATIC_RESERVED;
+static bool               g_static_sem_used[OTR_CONFIG_STATIC_LWIP_SEMAPHORES] OTR_STATIC_RESERVED;
+static struct static_mbox g_static_mboxes[STATIC_MBOX_COUNT] OTR_STATIC_RESERVED;
+static bool               g_static_mbox_used[STATIC_MBOX_COUNT] OTR_STATIC_RESERVED;
+static void *             g_static_tcpip_mbox_storage[TCPIP_MBOX_SIZE] OTR_STATIC_RESERVED;
+static void *g_static_mbox_storage[OTR_CONFIG_STATIC_LWIP_MBOXES][STATIC_MBOX_CAPACITY] OTR_STATIC_RESERVED;
+static StackType_t  g_static_thread_stack[TCPIP_THREAD_STACKSIZE] OTR_STATIC_RESERVED;
+static StaticTask_t g_static_thread OTR_STATIC_RESERVED;
+static bool         g_static_thread_used OTR_STATIC_RESERVED;
+
+static int static_pool_alloc(bool *used, int first, int count)
+{
+    int index = -1;
+
+    taskENTER_CRITICAL();
+
+    for (int i = first; i < count && index < 0; i++)
+    {
+        if (!used[i])
+        {
+            used[i] = true;
+            index   = i;
+        }
+    }
+
+    taskEXIT_CRITICAL();
+
+    return index;
+}
+
+static void static_pool_free(bool *used, const void *buffers, size_t size, int count, const void *object)
+{
+    uintptr_t offset = (uintptr_t)object - (uintptr_t)buffers;
+
+    /* Objects that are not from this pool are left alone. */
+    if (offset < size * count)
+    {
+        used[offset / size] = false;
+    }
+}
+#endif
 
 #if !LWIP_COMPAT_MUTEX
+static otrLockStatsLock lockStatsLock(sys_mutex_t *mutex)
+{
+    otrLockStatsLock lock = OTR_LOCK_STATS_LWIP_OTHER;
+
+    if (*mutex == lock_tcpip_core)
+    {
+        lock = OTR_LOCK_STATS_TCPIP_CORE;
+    }
+
+    return lock;
+}
+
 err_t sys_mutex_new(sys_mutex_t *mutex)
 {
     err_t err = ERR_MEM;
 
+#if OTR_CONFIG_STATIC_ALLOCATION
+    int index = static_pool_alloc(g_static_mutex_used, 0, OTR_CONFIG_STATIC_LWIP_MUTEXES);
+
+    *mutex = (index < 0) ? NULL : xSemaphoreCreateMutexStatic(&g_static_mutexes[index]);
+#else
     *mutex = xSemaphoreCreateMutex();
+#endif
 
     if (*mutex != NULL)
     {
@@ -63,33 +141,55 @@ err_t sys_mutex_new(sys_mutex_t *mutex)
 
 void sys_mutex_lock(sys_mutex_t *mutex)
 {
+#if OTR_CONFIG_LOCK_STATS
+    uint32_t waitStart = otrLockStatsWaitBegin();
+    bool     contended = (xSemaphoreTake(*mutex, 0) != pdPASS);
+
+    while (contended && xSemaphoreTake(*mutex, portMAX_DELAY) != pdPASS)
+        ;
+
+    otrLockStatsAcquired(lockStatsLock(mutex), *mutex, waitStart, contended);
+#else
     while (xSemaphoreTake(*mutex, portMAX_DELAY) != pdPASS)
         ;
+#endif
 }
 
 err_t sys_mutex_trylock(sys_mutex_t *mutex)
 {
-    if (xSemaphoreTake(*mutex, 0) == pdPASS)
-        return 0;
-    else
+    if (xSemaphoreTake(*mutex, 0) != pdPASS)
         return -1;
+
+    otrLockStatsAcquired(lockStatsLock(mutex), *mutex, otrLockStatsWaitBegin(), false);
+    return 0;
 }
 
 void sys_mutex_unlock(sys_mutex_t *mutex)
 {
+    otrLockStatsReleased(lockStatsLock(mutex), *mutex);
     xSemaphoreGive(*mutex);
 }
 
 void sys_mutex_free(sys_mutex_t *mutex)
 {
     vQueueDelete(*mutex);
+#if OTR_CONFIG_STATIC_ALLOCATION
+    static_pool_free(g_static_mutex_used, g_static_mutexes, sizeof(g_static_mutexes[0]), OTR_CONFIG_STATIC_LWIP_MUTEXES,
+                     *mutex);
+#endif
 }
 #endif
 
 err_t sys_sem_new(sys_sem_t *sem, u8_t count)
 {
     err_t err = ERR_MEM;
-    *sem      = xSemaphoreCreateBinary();
+#if OTR_CONFIG_STATIC_ALLOCATION
+    int index = static_pool_alloc(g_static_sem_used, 0, OTR_CONFIG_STATIC_LWIP_SEMAPHORES);
+
+    *sem = (index < 0) ? NULL : xSemaphoreCreateBinaryStatic(&g_static_sems[index]);
+#else
+    *sem = xSemaphoreCreateBinary();
+#endif
 
     if ((*sem) != NULL)
     {
@@ -104,26 +204,119 @@ err_t sys_sem_new(sys_sem_t *sem, u8_t count)
     return err;
 }
 
+#if LWIP_NETCONN_SEM_PER_THREAD
+/*
+ * A thread semaphore is a sys_sem_t holding this tag, followed by the task that owns it. lwIP passes the address of
+ * the sys_sem_t around, which leads back to the task to notify.
+ */
+static uint8_t g_thread_sem_tag;
+
+#define THREAD_SEM_TAG ((sys_sem_t)&g_thread_sem_tag)
+
+struct sys_thread_sem
+{
+    sys_sem_t    sem;
+    TaskHandle_t task;
+};
+
+sys_sem_t *sys_thread_sem_get(void)
+{
+    struct sys_thread_sem *thread_sem = pvTaskGetThreadLocalStoragePointer(NULL, SYS_THREAD_SEM_TLS_INDEX);
+
+    if (thread_sem == NULL)
+    {
+        thread_sem = mem_malloc(sizeof(*thread_sem));
+        LWIP_ASSERT("sys_thread_sem_get: out of memory", thread_sem != NULL);
+
+        thread_sem->sem  = THREAD_SEM_TAG;
+        thread_sem->task = xTaskGetCurrentTaskHandle();
+        vTaskSetThreadLocalStoragePointer(NULL, SYS_THREAD_SEM_TLS_INDEX, thread_sem);
+    }
+
+    return &thread_sem->sem;
+}
+
+void sys_thread_sem_free(void)
+{
+    struct sys_thread_sem *thread_sem = pvTaskGetThreadLocalStoragePointer(NULL, SYS_THREAD_SEM_TLS_INDEX);
+
+    if (thread_sem != NULL)
+    {
+        vTaskSetThreadLocalStoragePointer(NULL, SYS_THREAD_SEM_TLS_INDEX, NULL);
+        mem_free(thread_sem);
+    }
+}
+
+static u32_t thread_sem_wait(u32_t timeout)
+{
+    u32_t        StartTime = sys_now();
+    portTickType StartTick = xTaskGetTickCount();
+    portTickType Ticks     = otrTimeMsToTicks(timeout);
+    portTickType Elapsed   = 0;
+    uint32_t     value     = 0;
+    uint32_t     consumed  = 0;
+    u32_t        ret       = SYS_ARCH_TIMEOUT;
+
+    /* The application may wait for other bits of the same notification value, only consume ours. */
+    do
+    {
+        if (xTaskNotifyWait(0, SYS_THREAD_SEM_NOTIFY_VALUE, &value,
+                            (timeout == 0) ? portMAX_DELAY : Ticks - Elapsed) == pdTRUE)
+        {
+            consumed |= value & ~SYS_THREAD_SEM_NOTIFY_VALUE;
+        }
+
+        if (value & SYS_THREAD_SEM_NOTIFY_VALUE)
+        {
+            ret = sys_now() - StartTime;
+            break;
+        }
+
+        Elapsed = xTaskGetTickCount() - StartTick;
+    } while (timeout == 0 || Elapsed < Ticks);
+
+    /* Notifications for other bits woke this wait up, keep them pending for their own waiters. */
+    if (consumed != 0)
+    {
+        xTaskNotify(xTaskGetCurrentTaskHandle(), consumed, eSetBits);
+    }
+
+    return ret;
+}
+#endif /* LWIP_NETCONN_SEM_PER_THREAD */
+
 void sys_sem_signal(sys_sem_t *sem)
 {
+#if LWIP_NETCONN_SEM_PER_THREAD
+    if (*sem == THREAD_SEM_TAG)
+    {
+        xTaskNotify(((struct sys_thread_sem *)sem)->task, SYS_THREAD_SEM_NOTIFY_VALUE, eSetBits);
+        return;
+    }
+#endif
+
     xSemaphoreGive(*sem);
 }
 
 u32_t sys_arch_sem_wait(sys_sem_t *sem, u32_t timeout)
 {
-    portTickType  StartTime, EndTime, Elapsed;
+    u32_t         StartTime;
     unsigned long ret;
 
-    StartTime = xTaskGetTickCount();
+#if LWIP_NETCONN_SEM_PER_THREAD
+    if (*sem == THREAD_SEM_TAG)
+    {
+        return thread_sem_wait(timeout);
+    }
+#endif
+
+    StartTime = sys_now();
 
     if (timeout != 0)
     {
-        if (xSemaphoreTake(*sem, timeout / portTICK_PERIOD_MS) == pdTRUE)
+        if (xSemaphoreTake(*sem, otrTimeMsToTicks(timeout)) == pdTRUE)
         {
-            EndTime = xTaskGetTickCount();
-            Elapsed = (EndTime - StartTime) * portTICK_PERIOD_MS;
-
-            ret = Elapsed;
+            ret = sys_now() - StartTime;
         }
         else
         {
@@ -135,10 +328,7 @@ u32_t sys_arch_sem_wait(sys_sem_t *sem, u32_t timeout)
         while (xSemaphoreTake(*sem, portMAX_DELAY) != pdTRUE)
             ;
 
-        EndTime = xTaskGetTickCount();
-        Elapsed = (EndTime - StartTime) * portTICK_PERIOD_MS;
-
-        ret = Elapsed;
+        ret = sys_now() - StartTime;
     }
 
     return ret;
@@ -147,39 +337,57 @@ u32_t sys_arch_sem_wait(sys_sem_t *sem, u32_t timeout)
 void sys_sem_free(sys_sem_t *sem)
 {
     vSemaphoreDelete(*sem);
+#if OTR_CONFIG_STATIC_ALLOCATION
+    static_pool_free(g_static_sem_used, g_static_sems, sizeof(g_static_sems[0]), OTR_CONFIG_STATIC_LWIP_SEMAPHORES,
+                     *sem);
+#endif
 }
 
+#if OTR_CONFIG_STATIC_ALLOCATION
 err_t sys_mbox_new(sys_mbox_t *mbox, int size)
 {
-    *mbox = mem_malloc(sizeof(struct sys_mbox_s));
-    if (*mbox == NULL)
+    void **storage;
+    int    index;
+
+    /* Entry 0 is reserved for the TCPIP thread mailbox, the only one larger than a connection mailbox. */
+    if (size <= STATIC_MBOX_CAPACITY)
     {
-        return ERR_MEM;
+        index   = static_pool_alloc(g_static_mbox_used, 1, STATIC_MBOX_COUNT);
+        storage = (index < 0) ? NULL : g_static_mbox_storage[index - 1];
     }
-
-    (*mbox)->os_mbox = xQueueCreate(size, sizeof(void *));
-
-    if ((*mbox)->os_mbox == NULL)
+    else if (size <= TCPIP_MBOX_SIZE)
     {
-        mem_free(*mbox);
-        return ERR_MEM;
+        index   = static_pool_alloc(g_static_mbox_used, 0, 1);
+        storage = g_static_tcpip_mbox_storage;
+    }
+    else
+    {
+        index = -1;
     }
 
-    if (sys_mutex_new(&((*mbox)->lock)) != ERR_OK)
+    if (index < 0)
     {
-        vQueueDelete((*mbox)->os_mbox);
-        mem_free(*mbox);
+        *mbox = NULL;
         return ERR_MEM;
     }
 
-    (*mbox)->alive = true;
+    *mbox = xQueueCreateStatic(size, sizeof(void *), (uint8_t *)storage, &g_static_mboxes[index].queue);
 
     return ERR_OK;
 }
+#else
+err_t sys_mbox_new(sys_mbox_t *mbox, int size)
+{
+    /* The queue is the whole mailbox, its control block and storage come from one allocation. */
+    *mbox = xQueueCreate(size, sizeof(void *));
+
+    return (*mbox == NULL) ? ERR_MEM : ERR_OK;
+}
+#endif
 
 void sys_mbox_post(sys_mbox_t *mbox, void *msg)
 {
-    while (xQueueSendToBack((*mbox)->os_mbox, &msg, portMAX_DELAY) != pdTRUE)
+    while (xQueueSendToBack(*mbox, &msg, portMAX_DELAY) != pdTRUE)
         ;
 }
 
@@ -187,7 +395,7 @@ err_t sys_mbox_trypost(sys_mbox_t *mbox, void *msg)
 {
     err_t err;
 
-    if (xQueueSend((*mbox)->os_mbox, &msg, (portTickType)0) == pdPASS)
+    if (xQueueSend(*mbox, &msg, (portTickType)0) == pdPASS)
     {
         err = ERR_OK;
     }
@@ -204,7 +412,7 @@ err_t sys_mbox_trypost_fromisr(sys_mbox_t *mbox, void *msg)
     err_t      err;
     BaseType_t xHigherPriorityTaskWoken;
 
-    if (xQueueSendFromISR((*mbox)->os_mbox, &msg, &xHigherPriorityTaskWoken) == pdPASS)
+    if (xQueueSendFromISR(*mbox, &msg, &xHigherPriorityTaskWoken) == pdPASS)
     {
         err = ERR_OK;
     }
@@ -223,11 +431,10 @@ err_t sys_mbox_trypost_fromisr(sys_mbox_t *mbox, void *msg)
 
 u32_t sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout)
 {
-    void *        dummyptr;
-    portTickType  StartTime, EndTime, Elapsed;
-    unsigned long ret;
+    void *dummyptr;
+    u32_t StartTime, Elapsed;
 
-    StartTime = xTaskGetTickCount();
+    StartTime = sys_now();
     if (msg == NULL)
     {
         msg = &dummyptr;
@@ -236,61 +443,33 @@ u32_t sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout)
     if (*mbox == NULL)
     {
         *msg = NULL;
-        return -1;
+        return SYS_ARCH_TIMEOUT;
     }
 
-    sys_mutex_lock(&(*mbox)->lock);
-
-    if (timeout != 0)
+    /*
+     * No lock around the receive: lwIP never frees a mailbox that a thread is still waiting on, so the queue alone is
+     * enough and each fetch costs a single kernel call.
+     */
+    if (timeout == 0)
     {
-        if (pdTRUE == xQueueReceive((*mbox)->os_mbox, &(*msg), timeout / portTICK_PERIOD_MS))
+        /* portMAX_DELAY only blocks forever with INCLUDE_vTaskSuspend, keep waiting otherwise. */
+        while (xQueueReceive(*mbox, msg, portMAX_DELAY) != pdTRUE)
         {
-            EndTime = xTaskGetTickCount();
-            Elapsed = (EndTime - StartTime) * portTICK_PERIOD_MS;
-
-            if (Elapsed == 0)
-            {
-                Elapsed = 1;
-            }
-
-            ret = Elapsed;
-        }
-        else
-        {
-            *msg = NULL;
-            ret  = SYS_ARCH_TIMEOUT;
         }
     }
-    else
+    else if (xQueueReceive(*mbox, msg, otrTimeMsToTicks(timeout)) != pdTRUE)
     {
-        while (1)
-        {
-            if (pdTRUE == xQueueReceive((*mbox)->os_mbox, &(*msg), portMAX_DELAY))
-            {
-                break;
-            }
-
-            if ((*mbox)->alive == false)
-            {
-                *msg = NULL;
-                break;
-            }
-        }
-
-        EndTime = xTaskGetTickCount();
-        Elapsed = (EndTime - StartTime) * portTICK_PERIOD_MS;
-
-        if (Elapsed == 0)
-        {
-            Elapsed = 1;
-        }
-
-        ret = Elapsed;
+        *msg = NULL;
+        return SYS_ARCH_TIMEOUT;
     }
 
-    sys_mutex_unlock(&(*mbox)->lock);
+    Elapsed = sys_now() - StartTime;
 
-    return ret;
+    /*
+     * As in the original port, a message that was already queued is reported as a 1 ms wait. lwIP itself only compares
+     * the result with SYS_ARCH_TIMEOUT, but applications calling sys_arch_mbox_fetch may rely on it being non-zero.
+     */
+    return (Elapsed == 0) ? 1 : Elapsed;
 }
 
 u32_t sys_arch_mbox_tryfetch(sys_mbox_t *mbox, void **msg)
@@ -303,7 +482,7 @@ u32_t sys_arch_mbox_tryfetch(sys_mbox_t *mbox, void **msg)
         msg = &dummy;
     }
 
-    if (pdTRUE == xQueueReceive((*mbox)->os_mbox, &(*msg), 0))
+    if (pdTRUE == xQueueReceive(*mbox, &(*msg), 0))
     {
         ret = ERR_OK;
     }
@@ -317,49 +496,20 @@ u32_t sys_arch_mbox_tryfetch(sys_mbox_t *mbox, void **msg)
 
 void sys_mbox_free(sys_mbox_t *mbox)
 {
-#define MAX_POLL_CNT 100
-#define PER_POLL_DELAY 20
-    uint16_t count     = 0;
-    bool     post_null = true;
+    void *msg;
 
-    (*mbox)->alive = false;
+    /* lwIP drains a mailbox before freeing it, anything left is a leak in the caller. */
+    LWIP_ASSERT("sys_mbox_free: mbox not empty", uxQueueMessagesWaiting(*mbox) == 0);
 
-    while (count++ < MAX_POLL_CNT)
+    while (xQueueReceive(*mbox, &msg, 0) == pdTRUE)
     {
-        if (!sys_mutex_trylock(&(*mbox)->lock))
-        {
-            sys_mutex_unlock(&(*mbox)->lock);
-            break;
-        }
-
-        if (post_null)
-        {
-            if (sys_mbox_trypost(mbox, NULL) != ERR_OK)
-            {
-            }
-            else
-            {
-                post_null = false;
-            }
-        }
-
-        if (count == (MAX_POLL_CNT - 1))
-        {
-            printf("WARNING: mbox %p had a consumer who never unblocked. Leaking!\n", (*mbox)->os_mbox);
-        }
-        vTaskDelay(PER_POLL_DELAY / portTICK_PERIOD_MS);
-    }
-
-    if (uxQueueMessagesWaiting((*mbox)->os_mbox))
-    {
-        xQueueReset((*mbox)->os_mbox);
-        /* Line for breakpoint.  Should never break here! */
-        __asm__ volatile("nop");
+        SYS_STATS_INC(mbox.err);
     }
 
-    vQueueDelete((*mbox)->os_mbox);
-    sys_mutex_free(&(*mbox)->lock);
-    mem_free(*mbox);
+    vQueueDelete(*mbox);
+#if OTR_CONFIG_STATIC_ALLOCATION
+    static_pool_free(g_static_mbox_used, g_static_mboxes, sizeof(g_static_mboxes[0]), STATIC_MBOX_COUNT, *mbox);
+#endif
     *mbox = NULL;
 }
 
@@ -368,7 +518,20 @@ sys_thread_t sys_thread_new(const char *name, lwip_thread_fn thread, void *arg,
     xTaskHandle   CreatedTask;
     portBASE_TYPE result;
 
+#if OTR_CONFIG_STATIC_ALLOCATION
+    /* lwIP only creates the TCPIP thread. */
+    if (g_static_thread_used || stacksize > TCPIP_THREAD_STACKSIZE)
+    {
+        return NULL;
+    }
+
+    g_static_thread_used = true;
+    CreatedTask          = xTaskCreateStatic(thread, name, TCPIP_THREAD_STACKSIZE, arg, prio, g_static_thread_stack,
+                                    &g_static_thread);
+    result               = pdPASS;
+#else
     result = xTaskCreate(thread, name, stacksize, arg, prio, &CreatedTask);
+#endif
 
     if (result == pdPASS)
     {
@@ -382,25 +545,35 @@ sys_thread_t sys_thread_new(const char *name, lwip_thread_fn thread, void *arg,
 
 void sys_init(void)
 {
-    if (ERR_OK != sys_mutex_new(&g_lwip_protect_mutex))
-    {
-        printf("sys_init: failed to init lwip protect mutex\n");
-    }
 }
 
+/*
+ * lwIP protects its pools and pbuf reference counts with these on every packet, so they must not cost a kernel call.
+ * On the nRF52840, raising BASEPRI to configMAX_SYSCALL_INTERRUPT_PRIORITY masks every interrupt allowed to use lwIP,
+ * works from interrupts as well as tasks, and nests by restoring the previous mask. On Linux interrupts are simulated
+ * and never enter lwIP, so a FreeRTOS critical section, which counts its own nesting, is enough.
+ */
 sys_prot_t sys_arch_protect(void)
 {
-    sys_mutex_lock(&g_lwip_protect_mutex);
-    return (sys_prot_t)1;
+#if defined PLATFORM_nrf52
+    return portSET_INTERRUPT_MASK_FROM_ISR();
+#else
+    taskENTER_CRITICAL();
+    return 0;
+#endif
 }
 
 void sys_arch_unprotect(sys_prot_t pval)
 {
+#if defined PLATFORM_nrf52
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(pval);
+#else
     (void)pval;
-    sys_mutex_unlock(&g_lwip_protect_mutex);
+    taskEXIT_CRITICAL();
+#endif
 }
 
 u32_t sys_now(void)
 {
-    return (xTaskGetTickCount() * portTICK_PERIOD_MS);
+    return (u32_t)(otrTimeGetUs() / 1000);
 }
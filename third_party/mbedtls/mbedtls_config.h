@@ -65,6 +65,12 @@
 
 #define MBEDTLS_DEBUG_C
 
+#if OTR_CONFIG_STATIC_ALLOCATION
+#ifndef MBEDTLS_MEMORY_BUFFER_ALLOC_C
+#define MBEDTLS_MEMORY_BUFFER_ALLOC_C
+#endif
+#endif
+
 #include "mbedtls/check_config.h"
 
 #endif /* MBEDTLS_CONFIG_H */
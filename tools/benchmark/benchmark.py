@@ -0,0 +1,454 @@
+#!/usr/bin/env python3
+#
+#  Copyright (c) 2020, The OpenThread Authors.
+#  All rights reserved.
+#
+#  Redistribution and use in source and binary forms, with or without
+#  modification, are permitted provided that the following conditions are met:
+#  1. Redistributions of source code must retain the above copyright
+#     notice, this list of conditions and the following disclaimer.
+#  2. Redistributions in binary form must reproduce the above copyright
+#     notice, this list of conditions and the following disclaimer in the
+#     documentation and/or other materials provided with the distribution.
+#  3. Neither the name of the copyright holder nor the
+#     names of its contributors may be used to endorse or promote products
+#     derived from this software without specific prior written permission.
+#
+#  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+#  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+#  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+#  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+#  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+#  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+#  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+#  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+#  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+#  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+#  POSSIBILITY OF SUCH DAMAGE.
+#
+"""Multi-node benchmark for the Linux simulation of OpenThread RTOS.
+
+Launches one ot_cli_linux process per node on the POSIX radio simulation,
+forms a Thread network with the topology described in a JSON file, runs the
+requested scenarios with the tcp_* CLI commands and prints the results as JSON.
+"""
+
+import argparse
+import collections
+import json
+import os
+import re
+import subprocess
+import sys
+import threading
+import time
+
+NETWORK = {
+    'panid': '0x1234',
+    'extpanid': '1111111122222222',
+    'networkkey': '00112233445566778899aabbccddeeff',
+    'channel': '15',
+    'networkname': 'OtrBenchmark',
+}
+
+SERVER_PORT = 7000
+
+
+class CommandError(Exception):
+    pass
+
+
+class Node(object):
+    """One ot_cli_linux process driven through its CLI."""
+
+    def __init__(self, binary, node_id, port_offset, log_dir):
+        self.id = node_id
+        self._lines = []
+        self._cond = threading.Condition()
+        self._log = open(os.path.join(log_dir, 'node-%d.log' % node_id), 'w')
+        env = dict(os.environ, PORT_OFFSET=str(port_offset))
+        self._process = subprocess.Popen([binary, str(node_id)],
+                                         stdin=subprocess.PIPE,
+                                         stdout=subprocess.PIPE,
+                                         stderr=subprocess.STDOUT,
+                                         env=env)
+        self._reader = threading.Thread(target=self._read, daemon=True)
+        self._reader.start()
+
+    def _read(self):
+        for raw in iter(self._process.stdout.readline, b''):
+            line = raw.decode('utf-8', 'replace').strip().lstrip('> ')
+            self._log.write(line + '\n')
+            self._log.flush()
+            with self._cond:
+                self._lines.append(line)
+                self._cond.notify_all()
+
+    def mark(self):
+        """Returns the position from which the next expect() searches."""
+        with self._cond:
+            return len(self._lines)
+
+    def expect(self, pattern, start, timeout):
+        """Waits for a line matching pattern at or after start.
+
+        Returns the match and the position after the matching line.
+        """
+        regex = re.compile(pattern)
+        deadline = time.time() + timeout
+        index = start
+        with self._cond:
+            while True:
+                while index < len(self._lines):
+                    match = regex.search(self._lines[index])
+                    index += 1
+                    if match:
+                        return match, index
+                remaining = deadline - time.time()
+                if remaining <= 0 or self._process.poll() is not None:
+                    raise TimeoutError('node %d: no "%s" within %ds' %
+                                       (self.id, pattern, timeout))
+                self._cond.wait(remaining)
+
+    def lines(self, start, end):
+        with self._cond:
+            return self._lines[start:end]
+
+    def send(self, command):
+        self._process.stdin.write((command + '\n').encode())
+        self._process.stdin.flush()
+
+    def command(self, command, timeout=10):
+        """Runs a CLI command and returns its output lines."""
+        start = self.mark()
+        self.send(command)
+        match, end = self.expect(r'^(Done|Error .*)$', start, timeout)
+        output = [
+            line for line in self.lines(start, end - 1)
+            if line and line != command
+        ]
+        if match.group(1) != 'Done':
+            raise CommandError('node %d: %s: %s' %
+                               (self.id, command, match.group(1)))
+        return output
+
+    def state(self):
+        return self.command('state')[-1]
+
+    def wait_state(self, states, timeout):
+        deadline = time.time() + timeout
+        while True:
+            state = self.state()
+            if state in states:
+                return state
+            if time.time() > deadline:
+                raise TimeoutError('node %d: still %s after %ds' %
+                                   (self.id, state, timeout))
+            time.sleep(0.2)
+
+    def mleid(self):
+        """Returns the mesh-local EID, the address that survives re-attach."""
+        try:
+            return self.command('ipaddr mleid')[-1]
+        except CommandError:
+            # Older CLIs, pick the mesh-local address that is no RLOC/ALOC.
+            for address in self.command('ipaddr'):
+                if address.startswith('fd') and ':0:ff:fe00:' not in address:
+                    return address
+        raise CommandError('node %d: no mesh-local EID' % self.id)
+
+    def close(self):
+        if self._process.poll() is None:
+            self._process.terminate()
+            try:
+                self._process.wait(5)
+            except subprocess.TimeoutExpired:
+                self._process.kill()
+                self._process.wait()
+        self._reader.join()
+        self._log.close()
+
+
+class Topology(object):
+
+    def __init__(self, path):
+        with open(path) as f:
+            spec = json.load(f)
+        default_name = os.path.splitext(os.path.basename(path))[0]
+        self.name = spec.get('name', default_name)
+        self.nodes = spec['nodes']
+        self.leader = spec.get('leader', self.nodes[0])
+        self.links = spec.get('links')
+        self.neighbors = collections.defaultdict(set)
+        for a, b in self.links or []:
+            self.neighbors[a].add(b)
+            self.neighbors[b].add(a)
+
+    def hops(self, source, destination):
+        """Returns the shortest path length between two nodes."""
+        if self.links is None:
+            return 0 if source == destination else 1
+        distance = {source: 0}
+        pending = collections.deque([source])
+        while pending:
+            node = pending.popleft()
+            for neighbor in self.neighbors[node]:
+                if neighbor not in distance:
+                    distance[neighbor] = distance[node] + 1
+                    pending.append(neighbor)
+        return distance.get(destination)
+
+    def attach_order(self):
+        """Returns the nodes ordered by hops from the leader."""
+        return sorted(self.nodes, key=lambda n: self.hops(self.leader, n))
+
+    def farthest(self):
+        return self.attach_order()[-1]
+
+
+def try_commands(node, commands):
+    """Runs the first command of a list the CLI knows, for renamed commands."""
+    for command in commands[:-1]:
+        try:
+            return node.command(command)
+        except CommandError:
+            pass
+    return node.command(commands[-1])
+
+
+def form_network(nodes, topology, timeout):
+    """Forms the network and returns the attach time of each node."""
+    if topology.links is not None:
+        extaddrs = {n.id: n.command('extaddr')[-1] for n in nodes.values()}
+        for node in nodes.values():
+            try_commands(
+                node, ['macfilter addr allowlist', 'macfilter addr whitelist'])
+            for neighbor in topology.neighbors[node.id]:
+                node.command('macfilter addr add %s' % extaddrs[neighbor])
+
+    for node in nodes.values():
+        for name in ('panid', 'extpanid', 'channel', 'networkname'):
+            node.command('%s %s' % (name, NETWORK[name]))
+        try_commands(node, [
+            'networkkey %s' % NETWORK['networkkey'],
+            'masterkey %s' % NETWORK['networkkey']
+        ])
+        # Upgrade to router right away so that multi-hop paths form quickly.
+        node.command('routerselectionjitter 1')
+
+    attach = {}
+    for node_id in topology.attach_order():
+        node = nodes[node_id]
+        start = time.time()
+        node.command('ifconfig up')
+        node.command('thread start')
+        states = ('leader',) if node_id == topology.leader else ('router',)
+        node.wait_state(states, timeout)
+        attach[node_id] = round(time.time() - start, 3)
+    return attach
+
+
+def start_server(server):
+    start = server.mark()
+    server.command('tcp_echo_server %d' % SERVER_PORT)
+    server.expect(r'tcp_echo_server: (Listening|Cannot)', start, 10)
+    return start
+
+
+def stop_server(server, start):
+    server.expect(r'tcp_echo_server: Finished', start, 30)
+
+
+def connect(client, address, timeout):
+    """Connects the client and returns the time it took, or None."""
+    start = client.mark()
+    began = time.time()
+    client.command('tcp_connect %s %d' % (address, SERVER_PORT))
+    match, _ = client.expect(r'tcp_client: (Connected|Cannot connect)', start,
+                             timeout)
+    if match.group(1) != 'Connected':
+        return None
+    return round(time.time() - began, 3)
+
+
+def disconnect(client):
+    start = client.mark()
+    client.command('tcp_disconnect')
+    client.expect(r'tcp_client: Disconnected', start, 10)
+
+
+def send(client, size, count, timeout):
+    """Runs tcp_send and parses its report."""
+    start = client.mark()
+    client.command('tcp_send %d %d' % (size, count))
+    _, end = client.expect(r'tcp_client: Send finished', start, timeout)
+    report = '\n'.join(client.lines(start, end))
+    result = {'size': size, 'count': count, 'completed': False}
+
+    patterns = {
+        'bytes': r'Data transmitted : (\d+) B',
+        'time_ms': r'Time\s+: (\d+) ms',
+    }
+    for key, pattern in patterns.items():
+        match = re.search(pattern, report)
+        if match:
+            result[key] = int(match.group(1))
+
+    match = re.search(r'Throughput\s+: (\d+)\.(\d+) Kb/s', report)
+    if match:
+        result['throughput_kbps'] = float('%s.%s' % match.groups())
+        result['completed'] = True
+
+    match = re.search(r'Latency\s+: Avg: (\d+) us Min: (\d+) us, Max: (\d+) us',
+                      report)
+    if match:
+        result['latency_us'] = dict(
+            zip(('avg', 'min', 'max'), (int(v) for v in match.groups())))
+    return result
+
+
+def run_transfer(nodes, args, size, count):
+    client = nodes[args.client]
+    server = nodes[args.server]
+    address = server.mleid()
+    server_start = start_server(server)
+    result = {'connect_s': connect(client, address, args.timeout)}
+    if result['connect_s'] is not None:
+        result.update(send(client, size, count, args.timeout))
+        disconnect(client)
+    stop_server(server, server_start)
+    return result
+
+
+def scenario_throughput(nodes, args):
+    return run_transfer(nodes, args, args.size, args.count)
+
+
+def scenario_latency(nodes, args):
+    return run_transfer(nodes, args, args.latency_size, args.count)
+
+
+def scenario_reconnect(nodes, args):
+    """Restarts Thread on the client, then measures re-attach and connect."""
+    client = nodes[args.client]
+    server = nodes[args.server]
+    address = server.mleid()
+    rounds = []
+    for _ in range(args.repeat):
+        client.command('thread stop')
+        began = time.time()
+        client.command('thread start')
+        client.wait_state(('child', 'router'), args.timeout)
+        reattach = round(time.time() - began, 3)
+        server_start = start_server(server)
+        connected = connect(client, address, args.timeout)
+        if connected is not None:
+            disconnect(client)
+        stop_server(server, server_start)
+        rounds.append({'reattach_s': reattach, 'connect_s': connected})
+    return {
+        'rounds': rounds,
+        'connected': sum(r['connect_s'] is not None for r in rounds),
+    }
+
+
+SCENARIOS = collections.OrderedDict([
+    ('throughput', scenario_throughput),
+    ('latency', scenario_latency),
+    ('reconnect', scenario_reconnect),
+])
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('topology', help='topology JSON file')
+    parser.add_argument('--binary',
+                        default='build/ot_cli_linux',
+                        help='path of ot_cli_linux')
+    parser.add_argument('--scenario',
+                        action='append',
+                        choices=list(SCENARIOS),
+                        help='scenario to run, repeatable (default: all)')
+    parser.add_argument('--client',
+                        type=int,
+                        help='client node (default: farthest from the leader)')
+    parser.add_argument('--server',
+                        type=int,
+                        help='server node (default: the leader)')
+    parser.add_argument('--size',
+                        type=int,
+                        default=1024,
+                        help='throughput segment size, at most 1024 bytes')
+    parser.add_argument('--latency-size',
+                        type=int,
+                        default=16,
+                        help='latency segment size in bytes')
+    parser.add_argument('--count',
+                        type=int,
+                        default=20,
+                        help='segments per transfer')
+    parser.add_argument('--repeat',
+                        type=int,
+                        default=3,
+                        help='rounds of the reconnect scenario')
+    parser.add_argument('--timeout',
+                        type=int,
+                        default=120,
+                        help='seconds to wait for any single step')
+    parser.add_argument('--port-offset',
+                        type=int,
+                        default=0,
+                        help='PORT_OFFSET of the simulated radio, to run '
+                        'several benchmarks on one host')
+    parser.add_argument('--log-dir',
+                        default='benchmark-logs',
+                        help='directory for the node logs')
+    parser.add_argument('--output', help='result file (default: stdout)')
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    topology = Topology(args.topology)
+    args.server = args.server or topology.leader
+    args.client = args.client or topology.farthest()
+    scenarios = args.scenario or list(SCENARIOS)
+    os.makedirs(args.log_dir, exist_ok=True)
+
+    results = {
+        'topology': topology.name,
+        'nodes': len(topology.nodes),
+        'client': args.client,
+        'server': args.server,
+        'hops': topology.hops(args.client, args.server),
+        'scenarios': {},
+    }
+
+    nodes = {}
+    try:
+        for node_id in topology.nodes:
+            nodes[node_id] = Node(args.binary, node_id, args.port_offset,
+                                  args.log_dir)
+        results['attach_s'] = form_network(nodes, topology, args.timeout)
+        for name in scenarios:
+            began = time.time()
+            result = SCENARIOS[name](nodes, args)
+            result['duration_s'] = round(time.time() - began, 3)
+            results['scenarios'][name] = result
+    except (CommandError, TimeoutError) as error:
+        results['error'] = str(error)
+    finally:
+        for node in nodes.values():
+            node.close()
+
+    output = json.dumps(results, indent=2, sort_keys=True)
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(output + '\n')
+    else:
+        print(output)
+    return 1 if 'error' in results else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())